@@ -17,6 +17,8 @@
 #include "PuzzleList.h"
 #include "Watchdog.h"
 #include "Random.h"
+#include "Progress.h"
+#include "Speculation.h"
 
 #define IDC_RANDOMIZE 0x401
 #define IDC_TOGGLESPEED 0x402
@@ -29,6 +31,9 @@
 #define IDT_RANDOMIZED 0x409
 #define IDC_TOGGLELASERS 0x410
 #define IDC_TOGGLESNIPES 0x411
+#define IDT_PROGRESS 0x412
+#define IDT_SPECULATE 0x413
+#define IDC_REGENERATE 0x414
 
 #define IDC_ADD 0x301
 #define IDC_REMOVE 0x302
@@ -73,11 +78,13 @@
 //Panel to edit
 int panel = 0x09E69;
 
-HWND hwndSeed, hwndRandomize, hwndCol, hwndRow, hwndElem, hwndColor, hwndLoadingText, hwndNormal, hwndExpert, hwndColorblind, hwndDoubleMode;
+HWND hwndSeed, hwndRandomize, hwndRegenerate, hwndCol, hwndRow, hwndElem, hwndColor, hwndLoadingText, hwndNormal, hwndExpert, hwndColorblind, hwndDoubleMode;
 std::shared_ptr<Panel> _panel;
 std::shared_ptr<Randomizer> randomizer = std::make_shared<Randomizer>();
 std::shared_ptr<Generate> generator = std::make_shared<Generate>();
 std::shared_ptr<Special> specialCase = std::make_shared<Special>(generator);
+std::shared_ptr<Progress> progress = std::make_shared<Progress>(); //Randomizing runs on its own thread, and the window checks on it with a timer
+std::shared_ptr<Speculation> speculation; //Puzzles being made ahead of time for the options in the window
 std::vector<byte> bytes;
 
 int ctr = 0;
@@ -93,11 +100,51 @@ bool doubleMode = false;
 int lastSeed;
 bool lastHard;
 bool colorblind;
+bool welcome = false; //Whether to welcome the player once randomizing finishes, since the save hadn't been randomized before
 std::vector<long long> shapePos = { SHAPE_11, SHAPE_12, SHAPE_13, SHAPE_14, SHAPE_21, SHAPE_22, SHAPE_23, SHAPE_24, SHAPE_31, SHAPE_32, SHAPE_33, SHAPE_34, SHAPE_41, SHAPE_42, SHAPE_43, SHAPE_44 };
 std::vector<long long> defaultShape = { SHAPE_21, SHAPE_31, SHAPE_32, SHAPE_33 }; //L-shape
 std::vector<long long> directions = { ARROW_UP_RIGHT, ARROW_UP, ARROW_UP_LEFT, ARROW_LEFT, 0, ARROW_RIGHT, ARROW_DOWN_LEFT, ARROW_DOWN, ARROW_DOWN_RIGHT }; //Order of directional check boxes
 float target;
 
+//The settings saved by the last randomization (only colorblind so far, since the rest are saved in the game)
+std::map<std::string, std::string> ReadConfig()
+{
+	std::map<std::string, std::string> settings;
+	std::ifstream configFile("WRPGconfig.txt");
+	if (configFile.is_open()) {
+		std::string setting, value;
+		while (!configFile.eof() && configFile.good()) {
+			std::getline(configFile, setting, ':');
+			std::getline(configFile, value);
+			settings[setting] = value;
+		}
+		configFile.close();
+	}
+	return settings;
+}
+
+//Stop the speculation without waiting for it, so the window doesn't freeze while it takes back its panels
+void CancelSpeculation()
+{
+	if (speculation) Speculation::retire(speculation);
+	speculation = nullptr;
+}
+
+//Start making the puzzles for the options in the window, unless that is already happening or they can't be made ahead of time
+void Speculate(HWND hwnd)
+{
+	if (progress->read().state == Progress::Running) return;
+	WCHAR seedText[100];
+	GetWindowText(hwndSeed, &seedText[0], 100);
+	int seed = _wtoi(seedText);
+	Speculation::Options options = { seed, hard, IsDlgButtonChecked(hwnd, IDC_COLORBLIND) == BST_CHECKED, doubleMode };
+	if (speculation && speculation->getOptions() == options) return;
+	CancelSpeculation();
+	//Random seeds are only picked once Randomize is clicked, and randomizing again has to be confirmed first
+	if (seed <= 0 || seed > 9999999 || Special::ReadPanelData<int>(0x00064, NUM_DOTS) > 5) return;
+	speculation = std::make_shared<Speculation>(options);
+}
+
 LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
 	static bool seedIsRNG = false;
@@ -108,12 +155,18 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
 		return 0;
 	}
 	else if (message == WM_DESTROY) {
+		progress->cancel();
+		CancelSpeculation();
+		progress->join();
+		Speculation::waitForRetired();
+		Memory::StopWriteBehind();
 		PostQuitMessage(0);
 	} else if (message == WM_COMMAND || message == WM_TIMER) {
 		switch (HIWORD(wParam)) {
 			// Seed contents changed
 			case EN_CHANGE:
 				seedIsRNG = false;
+				SetTimer(hwnd, IDT_SPECULATE, 500, NULL);
 		}
 		switch (LOWORD(wParam)) {
 
@@ -129,22 +182,37 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
 		//Difficulty selection
 		case IDC_DIFFICULTY_NORMAL:
 			hard = false;
+			SetTimer(hwnd, IDT_SPECULATE, 500, NULL);
 			break;
 		case IDC_DIFFICULTY_EXPERT:
 			hard = true;
+			SetTimer(hwnd, IDT_SPECULATE, 500, NULL);
 			break;
 		case IDC_COLORBLIND:
 			colorblind = !IsDlgButtonChecked(hwnd, IDC_COLORBLIND);
 			CheckDlgButton(hwnd, IDC_COLORBLIND, colorblind);
+			SetTimer(hwnd, IDT_SPECULATE, 500, NULL);
 			break;
 		case IDC_DOUBLE:
 			doubleMode = !IsDlgButtonChecked(hwnd, IDC_DOUBLE);
 			CheckDlgButton(hwnd, IDC_DOUBLE, doubleMode);
+			SetTimer(hwnd, IDT_SPECULATE, 500, NULL);
+			break;
+
+		//The options haven't changed for a bit, so start on their puzzles
+		case IDT_SPECULATE:
+			KillTimer(hwnd, IDT_SPECULATE);
+			Speculate(hwnd);
 			break;
 
 		//Randomize button
 		case IDC_RANDOMIZE:
 		{
+			if (progress->read().state == Progress::Running) { //The button cancels while randomizing
+				progress->cancel();
+				SetWindowText(hwndRandomize, L"Cancelling...");
+				break;
+			}
 			bool rerandomize = false;
 			if (Special::ReadPanelData<int>(0x00064, NUM_DOTS) > 5) {
 				if (MessageBox(hwnd, L"Game is currently randomized. Are you sure you want to randomize again? (Can cause glitches)", NULL, MB_YESNO) == IDYES) {
@@ -240,18 +308,101 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
 			else {
 				std::remove("WRPGconfig.txt");
 			}
-			SetWindowText(hwndRandomize, L"Randomizing...");
+			SetWindowText(hwndRandomize, L"Cancel");
 			randomizer->seed = seed;
 			randomizer->colorblind = IsDlgButtonChecked(hwnd, IDC_COLORBLIND);
 			randomizer->doubleMode = doubleMode;
-			if (hard) randomizer->GenerateHard(hwndLoadingText);
-			else randomizer->GenerateNormal(hwndLoadingText);
-			Special::WritePanelData(0x00064, BACKGROUND_REGION_COLOR + 12, seed);
-			Special::WritePanelData(0x00182, BACKGROUND_REGION_COLOR + 12, hard);
-			Special::WritePanelData(0x0A3B2, BACKGROUND_REGION_COLOR + 12, doubleMode);
-			SetWindowText(hwndRandomize, L"Randomized!");
-			SetWindowText(hwndSeed, std::to_wstring(seed).c_str());
+			bool isHard = hard, isDouble = doubleMode;
+			std::function<void()> writeSettings = [seed, isHard, isDouble]() {
+				Special::WritePanelData(0x00064, BACKGROUND_REGION_COLOR + 12, seed);
+				Special::WritePanelData(0x00182, BACKGROUND_REGION_COLOR + 12, isHard);
+				Special::WritePanelData(0x0A3B2, BACKGROUND_REGION_COLOR + 12, isDouble);
+			};
+			welcome = !Special::hasBeenRandomized();
+			Speculation::Options options = { seed, isHard, randomizer->colorblind, isDouble };
+			if (speculation && speculation->getOptions() == options && !randomizer->seedIsRNG && speculation->getProgress()->read().state == Progress::Running) {
+				//These puzzles are already made (or on their way), so they just have to be written
+				progress = speculation->getProgress();
+				speculation->adopt(writeSettings);
+			}
+			else {
+				CancelSpeculation();
+				progress->run([p = progress, isHard, writeSettings]() { //The window can replace progress while this runs
+					Speculation::waitForRetired();
+					if (isHard) randomizer->GenerateHard(NULL, p);
+					else randomizer->GenerateNormal(NULL, p);
+					writeSettings();
+				});
+			}
+			SetTimer(hwnd, IDT_PROGRESS, 100, NULL);
+			break;
+		}
 
+		//Regenerate the areas and panels listed in the text box, with the seed and difficulty the game was randomized with
+		case IDC_REGENERATE:
+		{
+			if (progress->read().state == Progress::Running) break;
+			if (Special::ReadPanelData<int>(0x00064, NUM_DOTS) <= 5) {
+				MessageBox(hwnd, L"The game hasn't been randomized yet.", NULL, MB_OK);
+				break;
+			}
+			WCHAR listText[200];
+			GetWindowText(hwndRegenerate, &listText[0], 200);
+			std::vector<std::wstring> areas;
+			std::vector<int> panels;
+			std::wstringstream list(listText);
+			std::wstring item;
+			while (std::getline(list, item, L',')) {
+				size_t start = item.find_first_not_of(L' '), end = item.find_last_not_of(L' ');
+				if (start == std::wstring::npos) continue;
+				item = item.substr(start, end - start + 1);
+				if (iswdigit(item[0])) panels.push_back(static_cast<int>(wcstol(item.c_str(), NULL, 0))); //Panel ids, e.g. 0x00064
+				else areas.push_back(item);
+			}
+			if (areas.empty() && panels.empty()) {
+				MessageBox(hwnd, L"Enter the areas (e.g. Swamp, Town) or panel ids (e.g. 0x00064) to regenerate, separated by commas.", NULL, MB_OK);
+				break;
+			}
+			int seed = Special::ReadPanelData<int>(0x00064, BACKGROUND_REGION_COLOR + 12);
+			if (seed != randomizer->seed) randomizer->seedIsRNG = false;
+			randomizer->seed = seed;
+			std::map<std::string, std::string> settings = ReadConfig(); //The checkbox may have changed since the game was randomized
+			randomizer->colorblind = settings.count("colorblind") && settings["colorblind"] == "true";
+			randomizer->doubleMode = (Special::ReadPanelData<int>(0x0A3B2, BACKGROUND_REGION_COLOR + 12) > 0);
+			bool isHard = (Special::ReadPanelData<int>(0x00182, BACKGROUND_REGION_COLOR + 12) > 0);
+			CancelSpeculation();
+			randomizer->ClearOffsets();
+			ShowWindow(hwndLoadingText, SW_SHOW);
+			SetWindowText(hwndRandomize, L"Cancel");
+			welcome = false;
+			progress->run([p = progress, isHard, areas, panels]() {
+				Speculation::waitForRetired();
+				randomizer->Regenerate(isHard, areas, panels, p);
+			});
+			SetTimer(hwnd, IDT_PROGRESS, 100, NULL);
+			break;
+		}
+
+		//Show how randomizing is going, and clean up once it stops
+		case IDT_PROGRESS:
+		{
+			Progress::Snapshot status = progress->read();
+			if (status.state == Progress::Running) {
+				SetWindowText(hwndLoadingText, status.describe().c_str());
+				break;
+			}
+			KillTimer(hwnd, IDT_PROGRESS);
+			progress->join();
+			if (status.state == Progress::Finished) {
+				SetWindowText(hwndLoadingText, L"Done!");
+				SetWindowText(hwndRandomize, L"Randomized!");
+				SetWindowText(hwndSeed, std::to_wstring(randomizer->seed).c_str());
+				if (welcome) MessageBox(hwnd, L"Welcome to the abyss.", L"Go.", MB_OK);
+			}
+			else {
+				SetWindowText(hwndLoadingText, status.describe().c_str());
+				SetWindowText(hwndRandomize, L"Randomize");
+			}
 			break;
 		}
 
@@ -410,7 +561,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance
 	RegisterClassW(&wndClass);
 
 	HWND hwnd = CreateWindow(WINDOW_CLASS, PRODUCT_NAME, WS_OVERLAPPEDWINDOW,
-      650, 200, 600, DEBUG ? 700 : 320, nullptr, nullptr, hInstance, nullptr);
+      650, 200, 600, DEBUG ? 700 : 355, nullptr, nullptr, hInstance, nullptr);
 
 	//Initialize memory globals constant depending on game version
 	Memory memory("witness64_d3d11.exe");
@@ -499,23 +650,24 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance
 		WS_TABSTOP | WS_VISIBLE | WS_CHILD | SS_LEFT,
 		400, 250, 160, 16, hwnd, NULL, hInstance, NULL);
 
-	std::ifstream configFile("WRPGconfig.txt");
-	if (configFile.is_open()) {
-		std::map<std::string, std::string> settings;
-		std::string setting, value;
-		while (!configFile.eof() && configFile.good()) {
-			std::getline(configFile, setting, ':');
-			std::getline(configFile, value);
-			settings[setting] = value;
-		}
-		if (settings.count("colorblind") && settings["colorblind"] == "true") {
-			colorblind = true;
-			CheckDlgButton(hwnd, IDC_COLORBLIND, true);
-		}
-		configFile.close();
+	CreateWindow(L"STATIC", L"Regenerate areas/panels:",
+		WS_TABSTOP | WS_VISIBLE | WS_CHILD | SS_LEFT,
+		10, 285, 160, 16, hwnd, NULL, hInstance, NULL);
+	hwndRegenerate = CreateWindow(MSFTEDIT_CLASS, L"",
+		WS_TABSTOP | WS_VISIBLE | WS_CHILD | WS_BORDER | ES_AUTOHSCROLL,
+		180, 280, 200, 26, hwnd, NULL, hInstance, NULL);
+	CreateWindow(L"BUTTON", L"Regenerate",
+		WS_TABSTOP | WS_VISIBLE | WS_CHILD | BS_PUSHBUTTON,
+		390, 280, 130, 26, hwnd, (HMENU)IDC_REGENERATE, hInstance, NULL);
+
+	std::map<std::string, std::string> settings = ReadConfig();
+	if (settings.count("colorblind") && settings["colorblind"] == "true") {
+		colorblind = true;
+		CheckDlgButton(hwnd, IDC_COLORBLIND, true);
 	}
 
 	ShowWindow(hwndLoadingText, SW_HIDE);
+	SetTimer(hwnd, IDT_SPECULATE, 500, NULL);
 
 	//---------------------Debug/editing controls (debug mode only)---------------------
 
@@ -0,0 +1,54 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "BarPatterns.h"
+
+//Indexed by the open directions of an intersection: 1 = up, 2 = right, 4 = down, 8 = left
+const int BarPatterns::_INTERSECTION_PATTERNS[16] = {
+	0, 0, 0, 1,
+	0, 0, 2, 8,
+	0, 4, 0, 7,
+	3, 6, 5, 9,
+};
+
+int BarPatterns::classify(const std::vector<std::vector<int>>& grid, Point pos, bool pillar) {
+	int width = static_cast<int>(grid.size()), height = static_cast<int>(grid[0].size());
+	int x = pos.first, y = pos.second;
+	int val = grid[x][y];
+	if (val == PATH) return 0;
+	bool gap = (val == Decoration::Gap_Row || val == Decoration::Gap_Column);
+	if (x % 2 == 1 && y % 2 == 0) return gap ? 0xD : 0xB;
+	if (x % 2 == 0 && y % 2 == 1) return gap ? 0xC : 0xA;
+	int mask = 0;
+	const int dx[4] = { 0, 1, 0, -1 }, dy[4] = { -1, 0, 1, 0 };
+	for (int i = 0; i < 4; i++) {
+		int nx = x + dx[i], ny = y + dy[i];
+		if (pillar) nx = (nx + width) % width;
+		if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+		if (grid[nx][ny] != PATH) mask |= 1 << i;
+	}
+	return _INTERSECTION_PATTERNS[mask];
+}
+
+//Single pass over the grid: a point counts if any of the 8 points around it is a cell of the region.
+std::vector<int> BarPatterns::histogram(const std::vector<std::vector<int>>& grid, const RegionKernel& kernel, const Bitboard& region) {
+	std::vector<int> result(NUM_PATTERNS, 0);
+	int width = static_cast<int>(grid.size()), height = static_cast<int>(grid[0].size());
+	for (int x = 0; x < width; x++) {
+		for (int y = 0; y < height; y++) {
+			bool touching = false;
+			for (int dx = -1; dx <= 1 && !touching; dx++) {
+				for (int dy = -1; dy <= 1 && !touching; dy++) {
+					if (dx == 0 && dy == 0) continue;
+					int cx = x + dx;
+					if (kernel.pillar) cx = (cx + width) % width;
+					touching = kernel.test(region, cx, y + dy);
+				}
+			}
+			if (touching) result[classify(grid, { x, y }, kernel.pillar)]++;
+		}
+	}
+	result[0] = 0;
+	return result;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "Bitboard.h"
+
+//Classifies the edges and intersections around a region into the patterns used by the bar symbols.
+//0:None 1:OOCC 2:COOC 3:CCOO 4:OCCO 5:COOO 6:OCOO 7:OOCO 8:OOOC 9:OOOO A:Column edge B:Row edge C:Gap_Column D:Gap_Row
+//For intersections, O/C is whether the line can go up, right, down, left (in that order).
+class BarPatterns {
+public:
+	static const int NUM_PATTERNS = 14;
+
+	//Pattern of a single edge or intersection (0 if it doesn't match any pattern)
+	static int classify(const std::vector<std::vector<int>>& grid, Point pos, bool pillar);
+	//Number of each pattern among the edges and intersections touching the region
+	static std::vector<int> histogram(const std::vector<std::vector<int>>& grid, const RegionKernel& kernel, const Bitboard& region);
+
+private:
+	static const int _INTERSECTION_PATTERNS[16];
+};
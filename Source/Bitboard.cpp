@@ -0,0 +1,217 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "Bitboard.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+bool Bitboard::any() const {
+	uint32_t bits = 0;
+	for (int y = 0; y < SIZE; y++) bits |= rows[y];
+	return bits != 0;
+}
+
+int Bitboard::count() const {
+	int total = 0;
+	for (int y = 0; y < SIZE; y++) {
+		for (uint32_t row = rows[y]; row; row &= row - 1) total++;
+	}
+	return total;
+}
+
+Point Bitboard::get_nth(int n) const {
+	for (int y = 0; y < SIZE; y++) {
+		for (uint32_t row = rows[y]; row; row &= row - 1) {
+			if (n-- > 0) continue;
+			int x = 0;
+			while (!((row >> x) & 1)) x++;
+			return Point(x, y);
+		}
+	}
+	return Point(-1, -1);
+}
+
+Bitboard& Bitboard::operator|=(const Bitboard& other) {
+	for (int y = 0; y < SIZE; y++) rows[y] |= other.rows[y];
+	return *this;
+}
+
+Bitboard& Bitboard::operator&=(const Bitboard& other) {
+	for (int y = 0; y < SIZE; y++) rows[y] &= other.rows[y];
+	return *this;
+}
+
+bool Bitboard::operator==(const Bitboard& other) const {
+	for (int y = 0; y < SIZE; y++) {
+		if (rows[y] != other.rows[y]) return false;
+	}
+	return true;
+}
+
+RegionKernel::RegionKernel(const std::vector<std::vector<int>>& grid, Point origin, bool pillar, bool openIsWall)
+{
+	this->pillar = pillar;
+	_openIsWall = openIsWall;
+	_gridWidth = static_cast<int>(grid.size());
+	_gridHeight = static_cast<int>(grid[0].size());
+	_originX = origin.first & 1;
+	_originY = origin.second & 1;
+	width = (_gridWidth - _originX + 1) / 2;
+	height = (_gridHeight - _originY + 1) / 2;
+	if (width > Bitboard::SIZE) width = Bitboard::SIZE;
+	if (height > Bitboard::SIZE) height = Bitboard::SIZE;
+	for (int y = 0; y < Bitboard::SIZE; y++) {
+		for (int x = 0; x < Bitboard::SIZE; x++) _labels[y][x] = -1;
+	}
+	build_masks(grid, _open, _east, _west, _south, _north);
+}
+
+bool RegionKernel::matches(const std::vector<std::vector<int>>& grid) const {
+	if (static_cast<int>(grid.size()) != _gridWidth || static_cast<int>(grid[0].size()) != _gridHeight) return false;
+	Bitboard open, east, west, south, north;
+	build_masks(grid, open, east, west, south, north);
+	return open == _open && east == _east && west == _west && south == _south && north == _north;
+}
+
+void RegionKernel::build_masks(const std::vector<std::vector<int>>& grid, Bitboard& open, Bitboard& east, Bitboard& west, Bitboard& south, Bitboard& north) const {
+	//A move crosses the edge (ex, ey) and lands on (tx, ty)
+	auto canMove = [&](int ex, int ey, int tx, int ty) {
+		if (pillar) {
+			ex = (ex + _gridWidth) % _gridWidth;
+			tx = (tx + _gridWidth) % _gridWidth;
+		}
+		if (tx < 0 || tx >= _gridWidth || ty < 0 || ty >= _gridHeight) return false;
+		if ((!pillar && (ex == 0 || ex + 1 == _gridWidth)) || ey == 0 || ey + 1 == _gridHeight) return false;
+		int edge = grid[ex][ey];
+		return edge != PATH && !(_openIsWall && edge == OPEN);
+	};
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			int gx = _originX + x * 2, gy = _originY + y * 2;
+			if ((grid[gx][gy] & Decoration::Empty) != Decoration::Empty) open.set(x, y);
+			if (canMove(gx + 1, gy, gx + 2, gy)) east.set(x, y);
+			if (canMove(gx - 1, gy, gx - 2, gy)) west.set(x, y);
+			if (canMove(gx, gy + 1, gx, gy + 2)) south.set(x, y);
+			if (canMove(gx, gy - 1, gx, gy - 2)) north.set(x, y);
+		}
+	}
+}
+
+//Grow the cells by one step in every direction that isn't blocked.
+//East/west moves past the end of a row wrap around, which only happens on pillars (the move masks are empty there otherwise).
+void RegionKernel::dilate(Bitboard& cells) const {
+#ifdef __AVX2__
+	//Rows moving south/north, padded so that row y-1 and y+1 can be loaded for any y
+	alignas(32) uint32_t fromNorth[Bitboard::SIZE + 8] = { }, fromSouth[Bitboard::SIZE + 8] = { };
+	for (int y = 0; y < Bitboard::SIZE; y += 8) {
+		__m256i c = _mm256_load_si256(reinterpret_cast<const __m256i*>(cells.rows + y));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(fromNorth + y + 1), _mm256_and_si256(c, _mm256_load_si256(reinterpret_cast<const __m256i*>(_south.rows + y))));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(fromSouth + y), _mm256_and_si256(c, _mm256_load_si256(reinterpret_cast<const __m256i*>(_north.rows + y))));
+	}
+	__m128i wrapShift = _mm_cvtsi32_si128(width - 1);
+	__m256i one = _mm256_set1_epi32(1);
+	for (int y = 0; y < Bitboard::SIZE; y += 8) {
+		__m256i c = _mm256_load_si256(reinterpret_cast<const __m256i*>(cells.rows + y));
+		__m256i e = _mm256_and_si256(c, _mm256_load_si256(reinterpret_cast<const __m256i*>(_east.rows + y)));
+		__m256i w = _mm256_and_si256(c, _mm256_load_si256(reinterpret_cast<const __m256i*>(_west.rows + y)));
+		__m256i spread = _mm256_or_si256(_mm256_slli_epi32(e, 1), _mm256_srl_epi32(e, wrapShift));
+		spread = _mm256_or_si256(spread, _mm256_or_si256(_mm256_srli_epi32(w, 1), _mm256_sll_epi32(_mm256_and_si256(w, one), wrapShift)));
+		spread = _mm256_or_si256(spread, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fromNorth + y)));
+		spread = _mm256_or_si256(spread, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fromSouth + y + 1)));
+		spread = _mm256_and_si256(spread, _mm256_load_si256(reinterpret_cast<const __m256i*>(_open.rows + y)));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(cells.rows + y), _mm256_or_si256(c, spread));
+	}
+#else
+	for (int y = 0; y < height; y++) {
+		uint32_t e = cells.rows[y] & _east.rows[y], w = cells.rows[y] & _west.rows[y];
+		uint32_t spread = e << 1 | e >> (width - 1) | w >> 1 | (w & 1) << (width - 1);
+		if (y > 0) spread |= cells.rows[y - 1] & _south.rows[y - 1];
+		if (y + 1 < height) spread |= cells.rows[y + 1] & _north.rows[y + 1];
+		cells.rows[y] |= spread & _open.rows[y];
+	}
+#endif
+}
+
+//Get the region containing the point (pos)
+Bitboard RegionKernel::flood(Point pos) const {
+	Bitboard seed;
+	if (contains(pos)) seed.set((pos.first - _originX) / 2, (pos.second - _originY) / 2);
+	return flood(seed);
+}
+
+//Get all points reachable from the seed points. Seed points are always included, even if they are Empty.
+Bitboard RegionKernel::flood(Bitboard seed) const {
+	Bitboard region = seed, last;
+	do {
+		last = region;
+		dilate(region);
+	} while (region != last);
+	return region;
+}
+
+//Split the whole lattice into regions at once, then count how many neighbors of each point are in another region.
+//Empty points don't belong to any region.
+void RegionKernel::label_regions() {
+	_regions.clear();
+	Bitboard remaining = _open;
+	for (int y = 0; y < height; y++) {
+		while (remaining.rows[y]) {
+			uint32_t row = remaining.rows[y];
+			int x = 0;
+			while (!((row >> x) & 1)) x++;
+			Bitboard seed;
+			seed.set(x, y);
+			Bitboard region = flood(seed);
+			for (int ry = y; ry < height; ry++) {
+				for (uint32_t bits = region.rows[ry]; bits; bits &= bits - 1) {
+					int rx = 0;
+					while (!((bits >> rx) & 1)) rx++;
+					_labels[ry][rx] = static_cast<int>(_regions.size());
+				}
+				remaining.rows[ry] &= ~region.rows[ry];
+			}
+			_regions.push_back(region);
+		}
+	}
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			int count = 0;
+			for (int dy = -1; dy <= 1; dy++) {
+				for (int dx = -1; dx <= 1; dx++) {
+					int nx = x + dx, ny = y + dy;
+					if (pillar) nx = (nx + width) % width;
+					if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+					if (_labels[ny][nx] != _labels[y][x]) count++;
+				}
+			}
+			_neighborCounts[y][x] = count;
+		}
+	}
+}
+
+int RegionKernel::get_label(Point pos) const {
+	if (!contains(pos)) return -1;
+	return _labels[(pos.second - _originY) / 2][(pos.first - _originX) / 2];
+}
+
+int RegionKernel::get_neighbor_count(Point pos) const {
+	if (!contains(pos)) return 0;
+	return _neighborCounts[(pos.second - _originY) / 2][(pos.first - _originX) / 2];
+}
+
+bool RegionKernel::contains(int x, int y) const {
+	if (x < 0 || y < 0 || (x & 1) != _originX || (y & 1) != _originY) return false;
+	return (x - _originX) / 2 < width && (y - _originY) / 2 < height;
+}
+
+std::set<Point> RegionKernel::to_points(const Bitboard& cells) const {
+	std::set<Point> points;
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			if (cells.get(x, y)) points.emplace(to_grid(x, y));
+		}
+	}
+	return points;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "GridTypes.h"
+#include <stdint.h>
+#include <set>
+#include <vector>
+
+//A set of points on the grid, stored as one 32-bit word per row.
+//For RegionKernel, bit x of row y is the point (2x + originX, 2y + originY), covering one parity class of the grid (e.g. all of the grid blocks).
+//Other users store the grid point (x, y) directly. Panels are never more than 32 points wide or tall.
+struct Bitboard {
+	static const int SIZE = 32;
+	alignas(32) uint32_t rows[SIZE];
+
+	Bitboard() : rows() { }
+	bool get(int x, int y) const { return (rows[y] >> x) & 1; }
+	void set(int x, int y) { rows[y] |= 1u << x; }
+	void reset(int x, int y) { rows[y] &= ~(1u << x); }
+	bool any() const;
+	int count() const;
+	Point get_nth(int n) const; //Position of the nth set bit, going row by row
+	Bitboard& operator|=(const Bitboard& other);
+	Bitboard& operator&=(const Bitboard& other);
+	bool operator==(const Bitboard& other) const;
+	bool operator!=(const Bitboard& other) const { return !(*this == other); }
+};
+
+//Flood fill kernel for finding the regions of a panel that are separated by the path.
+//Builds masks of which moves are allowed between neighboring points, then grows regions by shift-and-mask dilation.
+class RegionKernel {
+public:
+	//origin - any point from the parity class to work on (normally a grid block)
+	//openIsWall - whether OPEN edges separate regions as well as PATH edges (the generator treats them that way)
+	RegionKernel(const std::vector<std::vector<int>>& grid, Point origin, bool pillar, bool openIsWall);
+
+	Bitboard flood(Point pos) const;
+	Bitboard flood(Bitboard seed) const;
+	void label_regions();
+	int get_label(Point pos) const; //Must call label_regions() first. -1 if the point isn't in any region.
+	int get_neighbor_count(Point pos) const; //Must call label_regions() first. Number of the 8 surrounding points on the grid that are in a different region.
+	const std::vector<Bitboard>& get_regions() const { return _regions; }
+
+	//Whether building the kernel from the grid would give the same moves, e.g. after only symbols were placed, so the regions can be kept
+	bool matches(const std::vector<std::vector<int>>& grid) const;
+
+	bool contains(int x, int y) const;
+	bool contains(Point pos) const { return contains(pos.first, pos.second); }
+	bool test(const Bitboard& cells, int x, int y) const { return contains(x, y) && cells.get((x - _originX) / 2, (y - _originY) / 2); }
+	Point to_grid(int x, int y) const { return Point(_originX + x * 2, _originY + y * 2); }
+	std::set<Point> to_points(const Bitboard& cells) const;
+
+	int width, height;
+	bool pillar;
+
+private:
+	void dilate(Bitboard& cells) const;
+	void build_masks(const std::vector<std::vector<int>>& grid, Bitboard& open, Bitboard& east, Bitboard& west, Bitboard& south, Bitboard& north) const;
+
+	bool _openIsWall;
+	int _originX, _originY;
+	int _gridWidth, _gridHeight;
+	Bitboard _open; //Points that can be entered (not Empty)
+	Bitboard _east, _west, _south, _north; //Points that may move one step in that direction
+	std::vector<Bitboard> _regions;
+	int _labels[Bitboard::SIZE][Bitboard::SIZE];
+	int _neighborCounts[Bitboard::SIZE][Bitboard::SIZE];
+};
@@ -0,0 +1,21 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "Difficulty.h"
+#include <cmath>
+
+Difficulty Difficulty::measure(const SolverStats& stats)
+{
+	Difficulty difficulty;
+	double expanded = static_cast<double>(stats.expandedNodes > 0 ? stats.expandedNodes : 1);
+	difficulty.branching = stats.moves / expanded;
+	difficulty.forcedRatio = stats.forcedNodes / expanded;
+	difficulty.deadEndDepth = stats.deadEnds && stats.solutions ? static_cast<double>(stats.deadEndLength) / stats.deadEnds / (static_cast<double>(stats.solutionLength) / stats.solutions) : 0;
+	difficulty.solutions = stats.solutions;
+	//Bits of search it takes to find each solution, scaled down when most moves are forced and up when wrong lines run long
+	double search = std::log2(static_cast<double>(stats.nodes > 0 ? stats.nodes : 1) / (stats.solutions > 0 ? stats.solutions : 1));
+	if (search < 0) search = 0;
+	difficulty.score = search * 4 * (1 - difficulty.forcedRatio / 2) * (0.5 + difficulty.deadEndDepth);
+	return difficulty;
+}
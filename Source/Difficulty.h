@@ -0,0 +1,15 @@
+#pragma once
+#include "Solver.h"
+
+//How hard a panel is, measured from the solver's search of it.
+//The search is a stand-in for a player: a lot of searching for each solution, few forced moves, and wrong lines that go on for a long time before failing all make a panel harder.
+struct Difficulty {
+	double branching; //Average number of moves from each point the search went on from
+	double forcedRatio; //Fraction of those points with only one move
+	double deadEndDepth; //Average length of the lines that failed, compared to the average solution
+	int solutions;
+	double score; //Higher is harder. An empty 4x4 grid scores about 14, and a 4x4 with a few symbols and one solution about 40.
+
+	//stats - from a search for every solution
+	static Difficulty measure(const SolverStats& stats);
+};
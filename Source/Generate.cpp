@@ -6,56 +6,67 @@
 #include "Randomizer.h"
 #include "MultiGenerate.h"
 #include "Special.h"
+#include "BarPatterns.h"
+#include "Solver.h"
+#include "Difficulty.h"
+#include "Pipeline.h"
+#include "PlacementSolver.h"
+#include <atomic>
+#include <exception>
+#include <limits.h>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 void Generate::generate(int id, int symbol, int amount) {
 	PuzzleSymbols symbols({ std::make_pair(symbol, amount) });
-	while (!generate(id, symbols));
+	run_attempts(id, symbols);
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2) });
-	while (!generate(id, symbols));
+	run_attempts(id, symbols);
 }
 
 void Generate::generate(int id, int symbol1, int amount1,  int symbol2, int amount2, int symbol3, int amount3) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3) });
-	while (!generate(id, symbols));
+	run_attempts(id, symbols);
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4) });
-	while (!generate(id, symbols));
+	run_attempts(id, symbols);
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4, int symbol5, int amount5) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4),  std::make_pair(symbol5, amount5) });
-	while (!generate(id, symbols));
+	run_attempts(id, symbols);
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4, int symbol5, int amount5, int symbol6, int amount6) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4),  std::make_pair(symbol5, amount5), std::make_pair(symbol6, amount6) });
-	while (!generate(id, symbols));
+	run_attempts(id, symbols);
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4, int symbol5, int amount5, int symbol6, int amount6, int symbol7, int amount7) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4),  std::make_pair(symbol5, amount5), std::make_pair(symbol6, amount6), std::make_pair(symbol7, amount7) });
-	while (!generate(id, symbols));
+	run_attempts(id, symbols);
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4, int symbol5, int amount5, int symbol6, int amount6, int symbol7, int amount7, int symbol8, int amount8) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4),  std::make_pair(symbol5, amount5), std::make_pair(symbol6, amount6), std::make_pair(symbol7, amount7), std::make_pair(symbol8, amount8) });
-	while (!generate(id, symbols));
+	run_attempts(id, symbols);
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4, int symbol5, int amount5, int symbol6, int amount6, int symbol7, int amount7, int symbol8, int amount8, int symbol9, int amount9) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4),  std::make_pair(symbol5, amount5), std::make_pair(symbol6, amount6), std::make_pair(symbol7, amount7), std::make_pair(symbol8, amount8), std::make_pair(symbol9, amount9) });
-	while (!generate(id, symbols));
+	run_attempts(id, symbols);
 }
 
 void Generate::generate(int id, const std::vector<std::pair<int, int>>& symbolVec)
 {
 	PuzzleSymbols symbols(symbolVec);
-	while (!generate(id, symbols));
+	run_attempts(id, symbols);
 }
 
 //Generate puzzle with multiple solutions. id - id of the puzzle. gens - the generators that will be used to make solutions. symbolVec - pairs of symbols and amounts to use
@@ -63,7 +74,10 @@ void Generate::generateMulti(int id, std::vector<std::shared_ptr<Generate>> gens
 {
 	MultiGenerate gen;
 	gen.splitStones = (id == 0x17C34); //Mountaintop
-	gen.generate(id, gens, symbolVec);
+	if (!gen.generate(id, gens, symbolVec, get_deadline(), _progress)) {
+		log_fallback(id, L"out of time, keeping the game's puzzle");
+		_skipped.insert(id);
+	}
 	incrementProgress();
 }
 
@@ -74,19 +88,193 @@ void Generate::generateMulti(int id, int numSolutions, std::vector<std::pair<int
 	gen.splitStones = (id == 0x17C34); //Mountaintop
 	std::vector<std::shared_ptr<Generate>> gens;
 	for (; numSolutions > 0; numSolutions--) gens.push_back(std::make_shared<Generate>());
-	gen.generate(id, gens, symbolVec);
+	if (!gen.generate(id, gens, symbolVec, get_deadline(), _progress)) {
+		log_fallback(id, L"out of time, keeping the game's puzzle");
+		_skipped.insert(id);
+	}
+	incrementProgress();
+}
+
+//Keep making attempts at the puzzle until one succeeds, then write it.
+//With a time budget, each step of the fallback ladder gets that long before moving on to the next.
+void Generate::run_attempts(int id, const PuzzleSymbols& symbols)
+{
+	if (_progress) {
+		_progress->checkCancelled();
+		_progress->setPuzzle(id);
+	}
+	if (!make_attempts(id, symbols, get_deadline())) {
+		int config = _config, maxSolutions = _maxSolutions;
+		double minDifficulty = _minDifficulty, maxDifficulty = _maxDifficulty;
+		bool done = false;
+		for (size_t i = 0; i < _fallbacks.size() && !done; i++) {
+			const Fallback& fallback = _fallbacks[i];
+			std::wstringstream text;
+			text << L"out of time, trying fallback " << i + 1 << L" of " << _fallbacks.size();
+			log_fallback(id, text.str());
+			_config = (config | fallback.addFlags) & ~fallback.removeFlags;
+			if (fallback.dropChecks) {
+				_maxSolutions = 0;
+				_minDifficulty = _maxDifficulty = 0;
+			}
+			PuzzleSymbols relaxed = relax_symbols(symbols, fallback.symbolPercent);
+			done = make_attempts(id, relaxed, get_deadline());
+			if (!done && i + 1 == _fallbacks.size() && hasFlag(Config::DisableWrite)) {
+				log_fallback(id, L"out of time on the last fallback, continuing without a time limit"); //The caller needs a puzzle to work with
+				done = make_attempts(id, relaxed, no_deadline());
+			}
+			_config = config;
+			_maxSolutions = maxSolutions;
+			_minDifficulty = minDifficulty;
+			_maxDifficulty = maxDifficulty;
+		}
+		if (!done && (_fallbacks.size() || !hasFlag(Config::DisableWrite))) {
+			log_fallback(id, L"out of time, keeping the game's puzzle");
+			skip(id);
+			return;
+		}
+		if (!done) make_attempts(id, symbols, no_deadline());
+	}
+	if (!hasFlag(Config::DisableWrite)) write(id);
+}
+
+//Make attempts at the puzzle until one succeeds, or until the deadline. The puzzle isn't written.
+//With attempt threads set, attempt i works on its own copy of the generator, with a random stream made from the seed, the puzzle id and i.
+//The attempts are spread over the threads and the lowest numbered one that succeeds is kept, so the puzzle doesn't depend on the number of threads.
+bool Generate::make_attempts(int id, const PuzzleSymbols& symbols, std::chrono::steady_clock::time_point deadline)
+{
+	if (_attemptThreads <= 0) {
+		int config = _config;
+		_config |= Config::DisableWrite;
+		bool done = true;
+		while (!generate(id, symbols)) {
+			if (_progress) _progress->addAttempt();
+			if (std::chrono::steady_clock::now() >= deadline || (_progress && _progress->isCancelled())) {
+				done = false;
+				break;
+			}
+		}
+		_config = config;
+		if (_progress) _progress->checkCancelled();
+		return done;
+	}
+	if (!_panel) initPanel(id); //Reads the game's memory, so it stays on this thread
+	std::mt19937 stream = Random::gen; //Put back afterward, so that this thread's stream doesn't depend on which attempts it ran
+	std::pair<int, int> tries = _placementTries[id];
+	int pillarWidth = Point::pillarWidth;
+	std::atomic<int> next(0), best(INT_MAX);
+	std::shared_ptr<Generate> winner;
+	std::mutex winnerMutex;
+	std::atomic<bool> failed(false);
+	std::exception_ptr error; //The first exception from an attempt, rethrown here once every thread has stopped
+	auto fail = [&](std::exception_ptr e) {
+		std::lock_guard<std::mutex> lock(winnerMutex);
+		if (!error) error = e;
+		failed = true;
+	};
+	auto work = [&]() {
+		Point::pillarWidth = pillarWidth;
+		try {
+			for (int i = next++; i < best.load() && !failed && std::chrono::steady_clock::now() < deadline && !(_progress && _progress->isCancelled()); i = next++) { //Attempts are handed out in order, so every one below the best gets finished
+				std::shared_ptr<Generate> attempt = std::make_shared<Generate>(*this);
+				attempt->_panel = std::make_shared<Panel>(*_panel);
+				attempt->_config |= Config::DisableWrite;
+				attempt->_placementTries[id] = { tries.first + i, tries.second + i }; //If this attempt is kept, all of the ones before it failed
+				Random::seed(attempt_seed(id, i));
+				if (!attempt->generate(id, symbols)) {
+					if (_progress) _progress->addAttempt();
+					continue;
+				}
+				std::lock_guard<std::mutex> lock(winnerMutex);
+				if (i < best.load()) {
+					best = i;
+					winner = attempt;
+				}
+			}
+		}
+		catch (...) {
+			fail(std::current_exception());
+		}
+	};
+	std::vector<std::thread> threads;
+	try {
+		for (int i = 1; i < _attemptThreads; i++) threads.emplace_back(work);
+	}
+	catch (...) {
+		fail(std::current_exception());
+	}
+	work();
+	for (std::thread& thread : threads) thread.join();
+	Random::gen = stream;
+	if (error) std::rethrow_exception(error);
+	if (_progress) _progress->checkCancelled();
+	if (!winner) return false;
+
+	_panel = winner->_panel;
+	_starts = winner->_starts;
+	_exits = winner->_exits;
+	_gridpos = winner->_gridpos;
+	_openpos = winner->_openpos;
+	_path = winner->_path;
+	_path1 = winner->_path1;
+	_path2 = winner->_path2;
+	_splitPoints = winner->_splitPoints;
+	_parity = winner->_parity;
+	_placementTries[id] = winner->_placementTries[id];
+	return true;
+}
+
+//Cut down the stones, triangles and dots for a fallback. Amounts of 25 or more are left alone, since they mean something other than a count.
+PuzzleSymbols Generate::relax_symbols(PuzzleSymbols symbols, int percent)
+{
+	for (int type : { Decoration::Stone, Decoration::Triangle, Decoration::Dot }) {
+		for (std::pair<int, int>& s : symbols[type]) {
+			if (s.second >= 25) continue;
+			int amount = s.second * percent / 100;
+			s.second = amount > 0 ? amount : 1;
+		}
+	}
+	return symbols;
+}
+
+void Generate::log_fallback(int id, const std::wstring& message)
+{
+	std::wstringstream text;
+	text << L"Panel 0x" << std::hex << id << std::dec << L" seed " << _seed << L": " << message << L"\n";
+	OutputDebugStringW(text.str().c_str());
+}
+
+//Leave the game's puzzle as it is, but move on as if this one had been written
+void Generate::skip(int id)
+{
 	incrementProgress();
+	_skipped.insert(id);
+	if (!hasFlag(Config::DisableReset)) resetVars();
+	end_puzzle();
+}
+
+//The seed for attempt number (attempt) at the puzzle
+int Generate::attempt_seed(int id, int attempt)
+{
+	std::seed_seq sequence{ static_cast<int>(_seed), id, attempt };
+	unsigned int seed;
+	sequence.generate(&seed, &seed + 1);
+	return static_cast<int>(seed);
 }
 
 std::vector<Point> Generate::_DIRECTIONS1 = { Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0) };
 std::vector<Point> Generate::_8DIRECTIONS1 = { Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0), Point(1, 1), Point(1, -1), Point(-1, -1), Point(-1, 1) };
 std::vector<Point> Generate::_DIRECTIONS2 = { Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0) };
 std::vector<Point> Generate::_8DIRECTIONS2 = { Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0), Point(2, 2), Point(2, -2), Point(-2, -2), Point(-2, 2) };
+//Each step also has everything the one before it gave up
+std::vector<Generate::Fallback> Generate::_FALLBACKS = {
+	{ Config::ShortPath | Config::SmallShapes, Config::LongPath | Config::LongestPath | Config::BigShapes, 100, false },
+	{ Config::ShortPath | Config::SmallShapes, Config::LongPath | Config::LongestPath | Config::BigShapes | Config::RequireCombineShapes | Config::RequireCancelShapes, 60, true },
+};
 std::vector<Point> Generate::_DISCONNECT = { Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0), Point(2, 2), Point(2, -2), Point(-2, -2), Point(-2, 2), 
 	Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0), Point(2, 2), Point(2, -2), Point(-2, -2), Point(-2, 2),
 	Point(0, 4), Point(0, -4), Point(4, 0), Point(-4, 0), //Used to make the discontiguous shapes
 };
-std::vector<Point> Generate::_SHAPEDIRECTIONS = { }; //This will eventually be set to one of the above lists
 
 //Make a maze puzzle. The maze will have one solution. id - id of the puzzle
 void Generate::generateMaze(int id) {
@@ -236,44 +424,21 @@ void Generate::write(int id)
 	else if (hasFlag(Config::TreehouseColors)) {
 		_panel->colorMode = colorblind ? Panel::ColorMode::TreehouseAlternate : Panel::ColorMode::Treehouse;
 	}
-	if (hasFlag(Config::Write2Color)) {
-		Special::WritePanelData(id, PATTERN_POINT_COLOR_A, _panel->_memory->ReadPanelData<Color>(0x0007C, PATTERN_POINT_COLOR_A));
-		Special::WritePanelData(id, PATTERN_POINT_COLOR_B, _panel->_memory->ReadPanelData<Color>(0x0007C, PATTERN_POINT_COLOR_B));
-		Special::WritePanelData(id, REFLECTION_PATH_COLOR, _panel->_memory->ReadPanelData<Color>(0x0007C, PATTERN_POINT_COLOR_B));
-		Special::WritePanelData(id, ACTIVE_COLOR, _panel->_memory->ReadPanelData<Color>(0x0007C, PATTERN_POINT_COLOR_A));
-	}
-	if (hasFlag(Config::WriteInvisible)) {
-		Special::WritePanelData(id, REFLECTION_PATH_COLOR, _panel->_memory->ReadPanelData<Color>(0x00076, REFLECTION_PATH_COLOR));
-	}
-	if (hasFlag(Config::WriteDotColor))
-		Special::WritePanelData(id, PATTERN_POINT_COLOR, { 0.1f, 0.1f, 0.1f, 1 });
-	if (hasFlag(Config::WriteDotColor2)) {
-		Color color = _panel->_memory->ReadPanelData<Color>(id, SUCCESS_COLOR_A);
-		Special::WritePanelData(id, PATTERN_POINT_COLOR, color);
-	}
-	if (arrowColor.a > 0 || backgroundColor.a > 0 || successColor.a > 0) {
-		Special::WritePanelData(id, OUTER_BACKGROUND, { backgroundColor });
-		if (arrowColor.a == 0)
-			Special::WritePanelData(id, BACKGROUND_REGION_COLOR, { _panel->_memory->ReadPanelData<Color>(id, SUCCESS_COLOR_A) });
-		Special::WritePanelData(id, BACKGROUND_REGION_COLOR, { arrowColor });
-		Special::WritePanelData(id, OUTER_BACKGROUND_MODE, 1);
-		if (successColor.a == 0) Special::WritePanelData(id, SUCCESS_COLOR_A, _panel->_memory->ReadPanelData<Color>(id, BACKGROUND_REGION_COLOR));
-		else Special::WritePanelData(id, SUCCESS_COLOR_A, successColor);
-		Special::WritePanelData(id, SUCCESS_COLOR_B, _panel->_memory->ReadPanelData<Color>(id, SUCCESS_COLOR_A));
-		Special::WritePanelData(id, ACTIVE_COLOR, { 1, 1, 1, 1 });
-		Special::WritePanelData(id, REFLECTION_PATH_COLOR, { 1, 1, 1, 1 });
-	}
-	if (hasFlag(Config::TreehouseLayout)) {
-		Special::WritePanelData(id, SPECULAR_ADD, 0.001f);
-	}
-
 	_panel->decorationsOnly = hasFlag(Config::DecorationsOnly);
 	_panel->enableFlash = hasFlag(Config::EnableFlash);
-	_panel->Write(id);
+	PanelImage image = { id, *_panel, Point::pillarWidth, _config, arrowColor, backgroundColor, successColor };
+	if (_deferWrites) _images.push_back(image);
+	else if (_pipeline && !hasFlag(Config::DisableReset)) _pipeline->add(image);
+	else commit(image);
 	
 	if (hasFlag(Config::DisableReset)) _panel->_grid = backupGrid;
 	else resetVars(); //Resets the generator data such as openpos, custom grids, etc. that doesn't persist across puzzles
+	end_puzzle();
+}
 
+//Undo the one-time config changes and move the seed on, once a puzzle is done
+void Generate::end_puzzle()
+{
 	//Undo any one-time config changes
 	if (_oneTimeAdd) {
 		_config &= ~_oneTimeAdd;
@@ -288,6 +453,56 @@ void Generate::write(int id)
 	_seed = Random::rand();
 }
 
+//Write a puzzle made by write() to the game, along with the colors its config flags call for
+void Generate::commit(const PanelImage& image)
+{
+	int id = image.id;
+	std::shared_ptr<Memory> memory = image.panel._memory;
+	if (image.config & Config::Write2Color) {
+		Special::WritePanelData(id, PATTERN_POINT_COLOR_A, memory->ReadPanelData<Color>(0x0007C, PATTERN_POINT_COLOR_A));
+		Special::WritePanelData(id, PATTERN_POINT_COLOR_B, memory->ReadPanelData<Color>(0x0007C, PATTERN_POINT_COLOR_B));
+		Special::WritePanelData(id, REFLECTION_PATH_COLOR, memory->ReadPanelData<Color>(0x0007C, PATTERN_POINT_COLOR_B));
+		Special::WritePanelData(id, ACTIVE_COLOR, memory->ReadPanelData<Color>(0x0007C, PATTERN_POINT_COLOR_A));
+	}
+	if (image.config & Config::WriteInvisible) {
+		Special::WritePanelData(id, REFLECTION_PATH_COLOR, memory->ReadPanelData<Color>(0x00076, REFLECTION_PATH_COLOR));
+	}
+	if (image.config & Config::WriteDotColor)
+		Special::WritePanelData(id, PATTERN_POINT_COLOR, { 0.1f, 0.1f, 0.1f, 1 });
+	if (image.config & Config::WriteDotColor2) {
+		Color color = memory->ReadPanelData<Color>(id, SUCCESS_COLOR_A);
+		Special::WritePanelData(id, PATTERN_POINT_COLOR, color);
+	}
+	if (image.arrowColor.a > 0 || image.backgroundColor.a > 0 || image.successColor.a > 0) {
+		Special::WritePanelData(id, OUTER_BACKGROUND, { image.backgroundColor });
+		if (image.arrowColor.a == 0)
+			Special::WritePanelData(id, BACKGROUND_REGION_COLOR, { memory->ReadPanelData<Color>(id, SUCCESS_COLOR_A) });
+		Special::WritePanelData(id, BACKGROUND_REGION_COLOR, { image.arrowColor });
+		Special::WritePanelData(id, OUTER_BACKGROUND_MODE, 1);
+		if (image.successColor.a == 0) Special::WritePanelData(id, SUCCESS_COLOR_A, memory->ReadPanelData<Color>(id, BACKGROUND_REGION_COLOR));
+		else Special::WritePanelData(id, SUCCESS_COLOR_A, image.successColor);
+		Special::WritePanelData(id, SUCCESS_COLOR_B, memory->ReadPanelData<Color>(id, SUCCESS_COLOR_A));
+		Special::WritePanelData(id, ACTIVE_COLOR, { 1, 1, 1, 1 });
+		Special::WritePanelData(id, REFLECTION_PATH_COLOR, { 1, 1, 1, 1 });
+	}
+	if (image.config & Config::TreehouseLayout) {
+		Special::WritePanelData(id, SPECULAR_ADD, 0.001f);
+	}
+
+	//The image may be written on another thread, or after other puzzles were made
+	int pillarWidth = Point::pillarWidth;
+	Point::pillarWidth = image.pillarWidth;
+	Panel panel = image.panel;
+	try {
+		panel.Write(id);
+	}
+	catch (...) {
+		Point::pillarWidth = pillarWidth;
+		throw;
+	}
+	Point::pillarWidth = pillarWidth;
+}
+
 //Reset all config flags and persistent settings, including width/height and symmetry.
 void Generate::resetConfig()
 {
@@ -301,6 +516,10 @@ void Generate::resetConfig()
 	_oneTimeAdd = Config::None;
 	_oneTimeRemove = Config::None;
 	arrowColor = backgroundColor = successColor = { 0, 0, 0, 0 };
+	_maxSolutions = 0;
+	_minDifficulty = _areaMinDifficulty;
+	_maxDifficulty = _areaMaxDifficulty;
+	_solveTimeBudget = _areaSolveTimeBudget;
 }
 
 //Increment the counter on the progress indicator. This is called each time a puzzle is written, but may be called manually in other situations
@@ -308,6 +527,7 @@ void Generate::incrementProgress()
 {
 	_areaTotal++;
 	_genTotal++;
+	if (_progress) _progress->puzzleDone();
 	if (_handle) {
 		int total = (_totalPuzzles == 0 ? _areaPuzzles : _totalPuzzles);
 		if (total == 0) return;
@@ -560,7 +780,14 @@ bool Generate::generate(int id, PuzzleSymbols symbols)
 	}
 
 	//Attempt to add the symbols
-	if (!place_all_symbols(symbols))
+	std::pair<int, int>& tries = _placementTries[id];
+	tries.first++;
+	if (!place_all_symbols(symbols)) {
+		tries.second++;
+		return false;
+	}
+
+	if ((_maxSolutions > 0 || _minDifficulty > 0 || _maxDifficulty > 0) && !check_solution_count(id))
 		return false;
 
 	if (!hasFlag(Config::DisableWrite)) write(id);
@@ -570,6 +797,7 @@ bool Generate::generate(int id, PuzzleSymbols symbols)
 //Place the provided symbols onto the puzzle. symbols - a structure describing types and amounts of symbols to add.
 bool Generate::place_all_symbols(PuzzleSymbols & symbols)
 {
+	bool useSolver = use_placement_solver(symbols); //If so, stones, triangles, dice, diamonds and stars are left for PlacementSolver
 	std::vector<int> eraseSymbols;
 	std::vector<int> eraserColors;
 	//If erasers are present, choose symbols to be erased and remove them pre-emptively
@@ -583,7 +811,7 @@ bool Generate::place_all_symbols(PuzzleSymbols & symbols)
 	//Symbols are placed in stages according to their type
 	//In each of these loops, s.first is the symbol and s.second is the amount of it to add
 
-	_SHAPEDIRECTIONS = (hasFlag(Config::DisconnectShapes) ? _DISCONNECT : _DIRECTIONS2);
+	_shapeDirections = (hasFlag(Config::DisconnectShapes) ? _DISCONNECT : _DIRECTIONS2);
 	int numShapes = 0, numRotate = 0, numNegative = 0;
 	std::vector<int> colors, negativeColors;
 	for (std::pair<int, int> s : symbols[Decoration::Poly]) {
@@ -604,9 +832,9 @@ bool Generate::place_all_symbols(PuzzleSymbols & symbols)
 
 	_stoneTypes = static_cast<int>(symbols[Decoration::Stone].size());
 	_bisect = true; //This flag helps the generator prevent making two adjacent regions of stones the same color
-	for (std::pair<int, int> s : symbols[Decoration::Stone]) if (!place_stones(s.first & 0xf, s.second))
+	if (!useSolver) for (std::pair<int, int> s : symbols[Decoration::Stone]) if (!place_stones(s.first & 0xf, s.second))
 		return false;
-	for (std::pair<int, int> s : symbols[Decoration::Triangle]) if (!place_triangles(s.first & 0xf, s.second, s.first >> 16))
+	if (!useSolver) for (std::pair<int, int> s : symbols[Decoration::Triangle]) if (!place_triangles(s.first & 0xf, s.second, s.first >> 16))
 		return false;
 	for (std::pair<int, int> s : symbols[Decoration::Arrow]) if (!place_arrows(s.first & 0xf, s.second, s.first >> 12))
 		return false;
@@ -633,7 +861,7 @@ bool Generate::place_all_symbols(PuzzleSymbols & symbols)
 		return false;
 	for (std::pair<int, int> s : symbols[Decoration::Pointer]) if (!place_pointers(s.first & 0xf, s.second))
 		return false;
-	for (std::pair<int, int> s : symbols[Decoration::Dice]) if (!place_dice(s.first & 0xf, s.second, (s.first & 0xf0000) >> 16))
+	if (!useSolver) for (std::pair<int, int> s : symbols[Decoration::Dice]) if (!place_dice(s.first & 0xf, s.second, (s.first & 0xf0000) >> 16))
 		return false;
 	for (std::pair<int, int> s : symbols[Decoration::Antitriangle]) if (!place_antitriangles(s.first & 0xf, s.second, (s.first & 0xf0000) >> 16))
 		return false;
@@ -641,10 +869,12 @@ bool Generate::place_all_symbols(PuzzleSymbols & symbols)
 		return false;
 	for (std::pair<int, int> s : symbols[Decoration::NewSymbolsF]) if (!place_newsymbolsF(s.first & 0xf, s.second))
 		return false;
-	for (std::pair<int, int> s : symbols[Decoration::Diamond]) if (!place_diamonds(s.first & 0xf, s.second, (s.first & 0xf0000) >> 16))
+	if (!useSolver) for (std::pair<int, int> s : symbols[Decoration::Diamond]) if (!place_diamonds(s.first & 0xf, s.second, (s.first & 0xf0000) >> 16))
 		return false;
 	//Added_End
-	for (std::pair<int, int> s : symbols[Decoration::Star]) if (!place_stars(s.first & 0xf, s.second))
+	if (!useSolver) for (std::pair<int, int> s : symbols[Decoration::Star]) if (!place_stars(s.first & 0xf, s.second))
+		return false;
+	if (useSolver && !place_with_solver(symbols))
 		return false;
 	if (symbols.style == Panel::Style::HAS_STARS && hasFlag(Generate::Config::TreehouseLayout) && !checkStarZigzag(_panel))
 		return false;
@@ -657,6 +887,84 @@ bool Generate::place_all_symbols(PuzzleSymbols & symbols)
 	return true;
 }
 
+//Whether placing symbols on this panel has failed often enough to hand the symbols PlacementSolver supports over to it
+bool Generate::use_placement_solver(PuzzleSymbols& symbols)
+{
+	if (_panel->id == 0x033EA) return false; //Keep Yellow Pressure Plate has a fixed triangle (see place_triangles)
+	if (!symbols.any(Decoration::Stone) && !symbols.any(Decoration::Triangle) && !symbols.any(Decoration::Dice) && !symbols.any(Decoration::Diamond) && !symbols.any(Decoration::Star))
+		return false;
+	const std::pair<int, int>& tries = _placementTries[_panel->id];
+	if (tries.first < _SOLVER_MIN_TRIES || tries.second * 100 < tries.first * _SOLVER_REJECTION_RATE) return false;
+	if (tries.first == _SOLVER_MIN_TRIES) {
+		std::wstringstream text;
+		text << L"Panel 0x" << std::hex << _panel->id << std::dec << L": " << tries.second << L" of " << tries.first << L" placements failed, switching to the placement solver\n";
+		OutputDebugStringW(text.str().c_str());
+	}
+	return true;
+}
+
+//Place stones, triangles, dice, diamonds and stars all at once by solving for them around the path (see PlacementSolver)
+bool Generate::place_with_solver(PuzzleSymbols& symbols)
+{
+	const RegionKernel& kernel = get_regions(Point(1, 1));
+	std::vector<PlacementRegion> regions;
+	for (const Bitboard& cells : kernel.get_regions()) {
+		PlacementRegion region;
+		std::set<Point> points = kernel.to_points(cells);
+		region.size = static_cast<int>(points.size());
+		for (Point p : points) {
+			if (_openpos.count(p)) {
+				bool allowTriangle = !((hasFlag(Config::TreehouseLayout) || _panel->id == 0x289E7) && next_to_endpoint(p));
+				region.open.push_back({ p, count_sides(p), allowTriangle, !in_center(p) });
+			}
+			else if (get(p)) region.symbols.push_back(get(p));
+		}
+		regions.push_back(region);
+	}
+	PlacementSolver solver(regions);
+	solver.stoneSpread = (_panel->_width / 2 + _panel->_height / 2 + 2) / 4;
+	for (int type : { Decoration::Stone, Decoration::Triangle, Decoration::Dice, Decoration::Diamond, Decoration::Star }) {
+		for (std::pair<int, int> s : symbols[type]) solver.add(s.first, s.second);
+	}
+	if (!solver.solve(_SOLVER_BUDGET))
+		return false;
+	for (const std::pair<Point, int>& placement : solver.get_placements()) {
+		set(placement.first, placement.second);
+		_openpos.erase(placement.first);
+	}
+	return true;
+}
+
+//Make sure the puzzle doesn't have more than the allowed number of solutions, and that its difficulty is in range.
+//If the solver runs out of time, the puzzle is kept. The difficulty of each puzzle kept is logged along with the seed.
+bool Generate::check_solution_count(int id)
+{
+	std::vector<std::vector<int>> grid = _panel->_grid;
+	for (int x = 0; x < _panel->_width; x++) {
+		for (int y = 0; y < _panel->_height; y++) {
+			if (grid[x][y] == PATH) grid[x][y] = 0;
+		}
+	}
+	Solver solver(grid, _starts, _exits, Point::pillarWidth);
+	if (_panel->symmetry) {
+		std::vector<std::vector<Point>> symmetry(_panel->_width, std::vector<Point>(_panel->_height));
+		for (int x = 0; x < _panel->_width; x++) {
+			for (int y = 0; y < _panel->_height; y++) symmetry[x][y] = get_sym_point(Point(x, y));
+		}
+		solver.set_symmetry(symmetry);
+	}
+	int count = solver.count_solutions(_maxSolutions > 0 ? _maxSolutions + 1 : 0, _solveTimeBudget);
+	if (_maxSolutions > 0 && count > _maxSolutions) return false;
+	if (solver.get_stats().timedOut) return true;
+	Difficulty difficulty = Difficulty::measure(solver.get_stats());
+	if (difficulty.score < _minDifficulty || (_maxDifficulty > 0 && difficulty.score > _maxDifficulty)) return false;
+	std::wstringstream text;
+	text << L"Panel 0x" << std::hex << id << std::dec << L" seed " << _seed << L": difficulty " << difficulty.score << L" (" << difficulty.solutions << L" solutions, branching " << difficulty.branching <<
+		L", forced " << difficulty.forcedRatio << L", dead ends " << difficulty.deadEndDepth << L")\n";
+	OutputDebugStringW(text.str().c_str());
+	return true;
+}
+
 //Generate a random path for a puzzle with the provided symbols.
 //The path starts at a random start and will not cross through walls or symbols.
 //Puzzle symbols are provided because they can influence how long the path should be.
@@ -926,25 +1234,21 @@ Point Generate::adjust_point(Point pos) {
 
 //Get the set of points in region containing the point (pos)
 std::set<Point> Generate::get_region(Point pos) {
-	std::set<Point> region;
-	std::vector<Point> check;
-	check.push_back(pos);
-	region.insert(pos);
-	while (check.size() > 0) {
-		Point p = check[check.size() - 1];
-		check.pop_back();
-		for (Point dir : _DIRECTIONS1) {
-			Point p1 = p + dir;
-			if (on_edge(p1)) continue;
-			if (get(p1) == PATH || get(p1) == OPEN) continue;
-			Point p2 = p + dir * 2;
-			if ((get(p2) & Decoration::Empty) == Decoration::Empty) continue;
-			if (region.insert(p2).second) {
-				check.push_back(p2);
-			}
-		}
+	const RegionKernel& kernel = get_regions(pos);
+	int label = kernel.get_label(pos);
+	return kernel.to_points(label >= 0 ? kernel.get_regions()[label] : kernel.flood(pos));
+}
+
+//The labeled regions for the points with the same parity as (pos). Placing symbols doesn't move the regions,
+//so they are only labeled again once the path, the gaps or the empty points change.
+const RegionKernel& Generate::get_regions(Point pos) {
+	std::shared_ptr<RegionKernel>& kernel = _regionCache[(pos.first & 1) * 2 + (pos.second & 1)];
+	bool pillar = Point::pillarWidth != 0;
+	if (!kernel || kernel->pillar != pillar || !kernel->matches(_panel->_grid)) {
+		kernel = std::make_shared<RegionKernel>(_panel->_grid, pos, pillar, true);
+		kernel->label_regions();
 	}
-	return region;
+	return *kernel;
 }
 
 //Get all the symbols in the region containing including the point (pos)
@@ -1037,118 +1341,159 @@ bool Generate::place_exit(int amount)
 	return true;
 }
 
-//Check if a gap can be placed at pos.
+//Check if a gap can be placed at pos. Dead ends from full gaps are handled separately by place_gaps.
 bool Generate::can_place_gap(Point pos) {
 	//Prevent putting open gaps at edges of the puzzle
-	if (pos.first == 0 || pos.second == 0) {
-		if (hasFlag(Config::FullGaps)) return false;
-	}
-	else if (Random::rand() % 2 == 0) return false; //Encourages gaps on outside border
+	if ((pos.first == 0 || pos.second == 0) && hasFlag(Config::FullGaps))
+		return false;
 	//Prevent putting a gap on top of a start/end point
 	if (_starts.count(pos) || _exits.count(pos))
 		return false;
 	//For symmetry puzzles, prevent putting two gaps symmetrically opposite 
-	if (_panel->symmetry && (get_sym_point(pos) == pos) || (get(get_sym_point(pos)) & Decoration::Gap)) return false;
+	if (_panel->symmetry && (get_sym_point(pos) == pos || (get(get_sym_point(pos)) & Decoration::Gap) || get(get_sym_point(pos)) == OPEN)) return false;
 	if ((_panel->symmetry == Panel::Symmetry::ParallelH || _panel->symmetry == Panel::Symmetry::ParallelHFlip) && pos.second == _panel->_height / 2) return false;
 	if ((_panel->symmetry == Panel::Symmetry::ParallelV || _panel->symmetry == Panel::Symmetry::ParallelVFlip) && pos.first == _panel->_width / 2) return false;
 	if (_panel->symmetry == Panel::Symmetry::FlipNegXY && (pos.first + pos.second == _width - 1 || pos.first + pos.second == _width + 1)) return false;
 	if (_panel->symmetry == Panel::Symmetry::FlipXY && (pos.first - pos.second == 1 || pos.first - pos.second == -1)) return false;
-	if (hasFlag(Config::FullGaps)) { //Prevent forming dead ends with open gaps
-		std::vector<Point> checkPoints = (pos.first % 2 == 0 ? std::vector<Point>({ Point(pos.first, pos.second - 1), Point(pos.first, pos.second + 1) })
-			: std::vector<Point>({ Point(pos.first - 1, pos.second), Point(pos.first + 1, pos.second) }));
-		for (Point check : checkPoints) {
-			int valid = 4;
+	return true;
+}
+
+//For each intersection, count the edges leaving it that haven't been cut by a gap or the edge of the puzzle
+std::vector<std::vector<int>> Generate::get_degree_map() {
+	std::vector<std::vector<int>> degree(_panel->_width, std::vector<int>(_panel->_height, 0));
+	for (int x = 0; x < _panel->_width; x += 2) {
+		for (int y = 0; y < _panel->_height; y += 2) {
 			for (Point dir : _DIRECTIONS1) {
-				Point p = check + dir;
-				if (off_edge(p) || get(p) & GAP || get(p) == OPEN) {
-					if (--valid <= 2) {
-						return false;
-					}
-				}
+				Point p = Point(x, y) + dir;
+				if (!off_edge(p) && !(get(p) & GAP) && get(p) != OPEN) degree[x][y]++;
 			}
 		}
 	}
-	return true;
+	return degree;
 }
 
-//Place the given amount of gaps radomly around the puzzle
+//A full gap at pos can't leave either of its intersections with fewer than two ways out
+bool Generate::makes_dead_end(Point pos, const std::vector<std::vector<int>>& degree) {
+	Point a = pos.first % 2 == 0 ? Point(pos.first, pos.second - 1) : Point(pos.first - 1, pos.second);
+	Point b = pos.first % 2 == 0 ? Point(pos.first, pos.second + 1) : Point(pos.first + 1, pos.second);
+	return degree[a.first][a.second] <= 2 || degree[b.first][b.second] <= 2;
+}
+
+//Place the given amount of gaps radomly around the puzzle. Gaps on the outside border are twice as likely.
 bool Generate::place_gaps(int amount) {
-	std::set<Point> open;
+	bool fullGaps = hasFlag(Config::FullGaps);
+	std::vector<std::vector<int>> degree;
+	if (fullGaps) degree = get_degree_map();
+	std::vector<std::pair<Point, int>> open; //Candidate edges and their weights. Every candidate is always valid, so none are drawn and rejected.
+	int totalWeight = 0;
 	for (int y = 0; y < _panel->_height; y++) {
 		for (int x = (y + 1) % 2; x < _panel->_width; x += 2) {
-			if (get(x, y) == 0 && (!_fullGaps || !on_edge(Point(x, y)))) {
-				open.emplace(Point(x, y));
-			}
+			Point pos(x, y);
+			if (get(x, y) != 0 || (_fullGaps && on_edge(pos)) || !can_place_gap(pos)) continue;
+			if (fullGaps && makes_dead_end(pos, degree)) continue;
+			open.emplace_back(pos, on_edge(pos) ? 2 : 1);
+			totalWeight += open.back().second;
 		}
 	}
 
 	while (amount > 0) {
 		if (open.size() == 0)
 			return false;
-		Point pos = pick_random(open);
-		if (can_place_gap(pos)) {
-			set(pos, _fullGaps ? OPEN : pos.first % 2 == 0 ? Decoration::Gap_Column : Decoration::Gap_Row);
-			amount--;
+		int roll = Random::rand() % totalWeight;
+		size_t i = 0;
+		while (roll >= open[i].second) roll -= open[i++].second;
+		Point pos = open[i].first;
+		set(pos, _fullGaps ? OPEN : pos.first % 2 == 0 ? Decoration::Gap_Column : Decoration::Gap_Row);
+		amount--;
+		if (fullGaps) {
+			for (Point dir : { Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0) }) {
+				Point p = pos + dir;
+				if ((p.first % 2 == 0) && (p.second % 2 == 0) && !off_edge(p)) degree[p.first][p.second]--;
+			}
+		}
+		//Drop the candidates this gap has ruled out: itself, its symmetric partner, and edges that would now make a dead end
+		Point sp = _panel->symmetry ? get_sym_point(pos) : pos;
+		for (auto it = open.begin(); it != open.end();) {
+			if (it->first == pos || it->first == sp || (fullGaps && makes_dead_end(it->first, degree))) {
+				totalWeight -= it->second;
+				it = open.erase(it);
+			}
+			else it++;
 		}
-		open.erase(pos);
 	}
 	return true;
 }
 
-//Check if a dot can be placed at pos.
-bool Generate::can_place_dot(Point pos, bool intersectionOnly) {
-	if (get(pos) & DOT)
-		return false;
-	if (_panel->symmetry) {
-		//For symmetry puzzles, make sure the current pos and symmetric pos are both valid
-		Point symPos = get_sym_point(pos);
-		if (symPos == pos) return false;
-		Panel::Symmetry backupSym = _panel->symmetry;
-		_panel->symmetry = Panel::Symmetry::None; //To prevent endless recursion
-		//if (!can_place_dot(get_sym_point(pos))) {
-		if (!can_place_dot(symPos, intersectionOnly)) {
-			_panel->symmetry = backupSym;
-			return false;
+//Build the dot masks from the dots already on the panel. Dots that only go on intersections are allowed 2 spaces apart less often.
+DotMasks Generate::get_dot_masks(bool intersectionOnly) {
+	DotMasks masks;
+	masks.spacedOdds = intersectionOnly ? 10 : 5;
+	for (int x = 0; x < _panel->_width; x++) {
+		for (int y = 0; y < _panel->_height; y++) {
+			if (get(x, y) & DOT) add_dot_mask(masks, Point(x, y));
 		}
-		_panel->symmetry = backupSym;
 	}
-	if (_panel->symmetry == Panel::Symmetry::RotateLeft && _path1.count(pos) && _path2.count(pos))
-		return false; //Prevent sharing of dots between symmetry lines
-	if (hasFlag(Config::DisableDotIntersection)) return true;
+	return masks;
+}
+
+//Add a dot to the masks, marking the points around it.
+//Diagonal points are allowed half of the time and points 2 spaces away 1 in spacedOdds times, rolled for here so checking a point doesn't use up rolls.
+void Generate::add_dot_mask(DotMasks& masks, Point pos) {
+	masks.dots.set(pos.first, pos.second);
 	for (Point dir : _8DIRECTIONS1) {
 		Point p = pos + dir;
-		if (!off_edge(p) && (get(p) & DOT)) {
-			//Don't allow adjacent dots
-			if (dir.first == 0 || dir.second == 0)
-				return false;
-			//Allow diagonally adjacent placement some of the time
-			if (Random::rand() % 2 > 0)
-				return false;
+		if (off_edge(p)) continue;
+		if (dir.first == 0 || dir.second == 0) masks.adjacent.set(p.first, p.second);
+		else if (Random::rand() % 2 > 0) masks.blocked.set(p.first, p.second);
+	}
+	for (Point dir : _DIRECTIONS2) {
+		Point p = pos + dir;
+		if (!off_edge(p) && Random::rand() % masks.spacedOdds > 0) masks.blocked.set(p.first, p.second);
+	}
+}
+
+//The points a dot can be placed on, given the dots in the masks. On symmetry puzzles, the symmetric point has to be allowed as well.
+Bitboard Generate::get_dot_spots(const DotMasks& masks) {
+	bool anyDistance = hasFlag(Config::DisableDotIntersection);
+	Bitboard allowed;
+	for (int x = 0; x < _panel->_width; x++) {
+		for (int y = 0; y < _panel->_height; y++) {
+			if (!masks.dots.get(x, y) && (anyDistance || (!masks.adjacent.get(x, y) && !masks.blocked.get(x, y)))) allowed.set(x, y);
 		}
 	}
-	//Allow 2-space horizontal/vertical placement some of the time
-	if (Random::rand() % (intersectionOnly ? 10 : 5) > 0) {
-		for (Point dir : _DIRECTIONS2) {
-			Point p = pos + dir;
-			if (!off_edge(p) && (get(p) & DOT)) {
-				return false;
-			}
+	if (!_panel->symmetry) return allowed;
+	Bitboard partners; //Points whose symmetric point is allowed
+	for (int x = 0; x < _panel->_width; x++) {
+		for (int y = 0; y < _panel->_height; y++) {
+			Point sp = get_sym_point(Point(x, y));
+			if (sp != Point(x, y) && allowed.get(sp.first, sp.second)) partners.set(x, y);
 		}
 	}
-	return true;
+	if (_panel->symmetry == Panel::Symmetry::RotateLeft) {
+		for (Point p : _path1) {
+			if (_path2.count(p)) partners.reset(p.first, p.second); //Prevent sharing of dots between symmetry lines
+		}
+	}
+	allowed &= partners;
+	return allowed;
 }
 
 //Place the given amount of dots at random points on the path
 bool Generate::place_dots(int amount, int color, bool intersectionOnly) {
+	if (!dot_masks_fit()) return false;
 	if (_parity != -1) { //For full dot puzzles, don't put dots on the starts and exits unless there are multiple
+		Bitboard fill;
 		for (int x = 0; x < _panel->_width; x += 2) {
 			for (int y = 0; y < _panel->_height; y += 2) {
-				if (_starts.size() == 1 && _starts.count(Point(x, y))) continue;
-				if (_exits.size() == 1 && _exits.count(Point(x, y))) continue;
-				if (get(x, y) == 0) continue;
-				set(x, y, Decoration::Dot_Intersection);
+				if (get(x, y) != 0) fill.set(x, y);
 			}
 		}
+		if (_starts.size() == 1) fill.reset(_starts.begin()->first, _starts.begin()->second);
+		if (_exits.size() == 1) fill.reset(_exits.begin()->first, _exits.begin()->second);
+		for (int n = fill.count() - 1; n >= 0; n--) {
+			Point p = fill.get_nth(n);
+			set(p, Decoration::Dot_Intersection);
+		}
 		return true;
 	}
 
@@ -1158,45 +1503,42 @@ bool Generate::place_dots(int amount, int color, bool intersectionOnly) {
 		color = IntersectionFlags::DOT_IS_ORANGE;
 	else color = 0;
 
-	std::set<Point> open = (color == 0 ? _path : color == IntersectionFlags::DOT_IS_BLUE ? _path1 : _path2);
-	for (Point p : _starts) open.erase(p);
-	for (Point p : _exits) open.erase(p);
-	for (Point p : blockPos) open.erase(p);
-	if (intersectionOnly) {
-		std::set<Point> intersections;
-		for (Point p : open) {
-			if (p.first % 2 == 0 && p.second % 2 == 0)
-				intersections.insert(p);
-		}
-		open = intersections;
-	}
-	if (hasFlag(Config::DisableDotIntersection)) {
-		std::set<Point> intersections;
-		for (Point p : open) {
-			if (p.first % 2 != 0 || p.second % 2 != 0)
-				intersections.insert(p);
-		}
-		open = intersections;
+	//Candidate points: the path, minus starts/exits/blocked points, minus points without a symmetric partner
+	Bitboard open;
+	for (Point p : (color == 0 ? _path : color == IntersectionFlags::DOT_IS_BLUE ? _path1 : _path2)) {
+		bool intersection = (p.first % 2 == 0 && p.second % 2 == 0);
+		if (intersectionOnly && !intersection) continue;
+		if (hasFlag(Config::DisableDotIntersection) && intersection) continue;
+		if (_panel->symmetry && get_sym_point(p) == p) continue;
+		open.set(p.first, p.second);
 	}
+	for (Point p : _starts) open.reset(p.first, p.second);
+	for (Point p : _exits) open.reset(p.first, p.second);
+	for (Point p : blockPos) open.reset(p.first, p.second);
 
+	DotMasks masks = get_dot_masks(intersectionOnly);
 	while (amount > 0) {
-		if (open.size() == 0)
+		open &= get_dot_spots(masks); //Spots only ever get taken away, so the ones that are gone can be forgotten
+		int numOpen = open.count();
+		if (numOpen == 0)
 			return false;
-		Point pos = pick_random(open);
-		open.erase(pos);
-		if (!can_place_dot(pos, intersectionOnly)) continue;
+		Point pos = open.get_nth(Random::rand() % numOpen);
+		open.reset(pos.first, pos.second);
 		int symbol = (pos.first & 1) == 1 ? Decoration::Dot_Row : (pos.second & 1) == 1 ? Decoration::Dot_Column : Decoration::Dot_Intersection;
 		set(pos, symbol | color);
+		add_dot_mask(masks, pos);
 		for (Point dir : _DIRECTIONS1) {
-			open.erase(pos + dir);
+			Point p = pos + dir;
+			if (!off_edge(p)) open.reset(p.first, p.second);
 		} //If symmetry, set a flag to break the point symmetric to the dot
 		if (_panel->symmetry) {
 			Point sp = get_sym_point(pos);
 			symbol = (sp.first & 1) == 1 ? Decoration::Dot_Row : (sp.second & 1) == 1 ? Decoration::Dot_Column : Decoration::Dot_Intersection;
 			if (symbol != Decoration::Dot_Intersection) set(sp, symbol & ~Decoration::Dot);
-			open.erase(sp);
+			open.reset(sp.first, sp.second);
 			for (Point dir : _DIRECTIONS1) {
-				open.erase(sp + dir);
+				Point p = sp + dir;
+				if (!off_edge(p)) open.reset(p.first, p.second);
 			}
 		}
 		amount--;
@@ -1279,7 +1621,7 @@ bool Generate::place_stones(int color, int amount) {
 
 //Generate a random shape. region - the region of points to choose from; points chosen will be removed.
 //bufferRegion - points that may be chosen twice due to overlapping shapes; points will be removed from here before points in region.
-//maxSize - the maximum size of the generated shape. Whether the points can be contiguous or not is determined by local variable _SHAPEDIRECTIONS
+//maxSize - the maximum size of the generated shape. Whether the points can be contiguous or not is determined by _shapeDirections
 Shape Generate::generate_shape(std::set<Point>& region, std::set<Point>& bufferRegion, Point pos, int maxSize)
 {
 	Shape shape;
@@ -1290,7 +1632,7 @@ Shape Generate::generate_shape(std::set<Point>& region, std::set<Point>& bufferR
 		pos = pick_random(shape);
 		int i = 0;
 		for (; i < 10; i++) {
-			Point dir = pick_random(_SHAPEDIRECTIONS);
+			Point dir = pick_random(_shapeDirections);
 			Point p = pos + dir;
 			if (region.count(p) && !shape.count(p)) {
 				shape.insert(p);
@@ -1397,7 +1739,7 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 				pos = pick_random(region);
 				//Try to pick a random point adjacent to a shape
 				for (int i = 0; i < 10; i++) {
-					Point p = pos + pick_random(_SHAPEDIRECTIONS);
+					Point p = pos + pick_random(_shapeDirections);
 					if (regionN.count(p) && !region.count(p)) {
 						pos = p;
 						break;
@@ -1686,16 +2028,7 @@ bool Generate::place_triangles(int color, int amount, int targetCount)
 			open.erase(get_sym_point(pos));
 		}
 		if (count == 0 || targetCount && count != targetCount) continue;
-		if (hasFlag(Config::TreehouseLayout) || _panel->id == 0x289E7) { //If the block is adjacent to a start or exit, don't place a triangle there
-			bool found = false;
-			for (Point dir : _DIRECTIONS1) {
-				if (_starts.count(pos + dir) || _exits.count(pos + dir)) {
-					found = true;
-					break;
-				}
-			}
-			if (found) continue;
-		}
+		if ((hasFlag(Config::TreehouseLayout) || _panel->id == 0x289E7) && next_to_endpoint(pos)) continue; //If the block is adjacent to a start or exit, don't place a triangle there
 		if (count == 1) {
 			if (!targetCount && count1 * 2 > count2 + count3 && Random::rand() % 2 == 0) continue;
 			count1++;
@@ -1715,6 +2048,15 @@ bool Generate::place_triangles(int color, int amount, int targetCount)
 	return true;
 }
 
+//Check if the block is next to a start or exit
+bool Generate::next_to_endpoint(Point pos)
+{
+	for (Point dir : _DIRECTIONS1) {
+		if (_starts.count(pos + dir) || _exits.count(pos + dir)) return true;
+	}
+	return false;
+}
+
 //Count how many sides are touched by the line (for the triangles)
 int Generate::count_sides(Point pos)
 {
@@ -1760,46 +2102,22 @@ bool Generate::place_arrows(int color, int amount, int targetCount)
 
 bool Generate::place_mines(int color, int amount, int target_num)
 {
-	std::set<Point> open = _openpos;
+	//Placing mines doesn't change the regions, so the neighbor counts only need to be found once
+	const RegionKernel& kernel = get_regions(Point(1, 1));
+	std::vector<Point> open;
+	for (Point pos : _openpos) {
+		if (in_center(pos)) continue;
+		if (target_num == 0 || kernel.get_neighbor_count(pos) == target_num) open.push_back(pos);
+	}
 	while (amount > 0) {
 		if (open.size() == 0)
 			return false;
-		Point pos = pick_random(open);
-		open.erase(pos);
-		if (in_center(pos)) continue;
-
-		std::set<Point> result;
-		std::set<Point> region = get_region(pos);
-		std::set<Point> nearby = {
-			pos + Point(2,0),pos + Point(0,2),pos + Point(0,-2), pos + Point(-2,0),
-			pos + Point(2,2), pos + Point(-2,2), pos + Point(-2,-2), pos + Point(2,-2),
-		};
-
-		int num = 0;
-		for (Point a : nearby) {
-			for (Point b : region) {
-				if (a.first == b.first && a.second == b.second) {
-					num += 1;
-				}
-			}
-		}
-		if ((pos.first == 1 || pos.first == _panel->_width - 2) && (pos.second == 1 || pos.second == _panel->_height - 2))
-		{
-			num = 3 - num;
-		}
-		else if ((pos.first == 1 || pos.first == _panel->_width - 2) || (pos.second == 1 || pos.second == _panel->_height - 2))
-		{
-			num = 5 - num;
-		}
-		else
-		{
-			num = 8 - num;
-		}
-		if (target_num == 0 || num == target_num) {
-			set(pos, Decoration::Mine | color | num << 16);//0x10(num)000(color)
-			amount--;
-		}
+		int i = Random::rand() % open.size();
+		Point pos = open[i];
+		open.erase(open.begin() + i);
+		set(pos, Decoration::Mine | color | kernel.get_neighbor_count(pos) << 16);//0x10(num)000(color)
 		_openpos.erase(pos);
+		amount--;
 	}
 	return true;
 }
@@ -1871,12 +2189,14 @@ bool Generate::place_erasers(const std::vector<int>& colors, const std::vector<i
 			set(pos, toErase);
 		}
 		else if (toErase & Decoration::Dot) { //Find an open edge to put the dot on
+			if (!dot_masks_fit()) continue;
 			std::set<Point> openEdge;
+			Bitboard spots = get_dot_spots(get_dot_masks(false));
 			for (Point p : region) {
 				for (Point dir : _8DIRECTIONS1) {
 					if (toErase == Decoration::Dot_Intersection && (dir.first == 0 || dir.second == 0)) continue;
 					Point p2 = p + dir;
-					if (get(p2) == 0 && (hasFlag(Config::FalseParity) || can_place_dot(p2, false))) {
+					if (get(p2) == 0 && (hasFlag(Config::FalseParity) || spots.get(p2.first, p2.second))) {
 						openEdge.insert(p2);
 					}
 				}
@@ -2126,8 +2446,11 @@ bool Generate::place_bars(int color, int amount,int shape)
 		//0:X(null) 1:(OOCC) 2:(COOC) 3:(CCOO) 4:(OCCO) 5:(COOO) 6:(OCOO) 7:(OOCO) 8:(OOOC) 9:(OOOO) A:(OCOC) B:(COCO) C:Gap_Column D:Gap_Row
 		std::set<Point> empty_region;
 		empty_region.insert(pos);
-		std::vector<int> region_data = get_region_grid_patterns(get_region_points(pos));
-		for (Point p : get_region(pos)) {
+		const RegionKernel& kernel = get_regions(pos);
+		int label = kernel.get_label(pos);
+		Bitboard region = label >= 0 ? kernel.get_regions()[label] : kernel.flood(pos);
+		std::vector<int> region_data = BarPatterns::histogram(_panel->_grid, kernel, region);
+		for (Point p : kernel.to_points(region)) {
 			if ((get(p) & 0xF000700) == Decoration::Bar) {
 				region_data[(get(p) & 0xF0000) >> 16] -= 1;
 			}
@@ -2163,74 +2486,6 @@ void Generate::DebugLog(int i) {
 	OutputDebugStringW(ws.data());
 }
 
-std::set<Point> Generate::get_region_points(Point pos) {
-	std::set<Point> result;
-	for (Point a : get_region(pos)) {
-		for (Point dir : _8DIRECTIONS1) {
-			result.insert(a + dir);
-		}
-	}
-	return result;
-}
-
-//0:X(null) 1:(OOCC) 2:(COOC) 3:(CCOO) 4:(OCCO) 5:(COOO) 6:(OCOO) 7:(OOCO) 8:(OOOC) 9:(OOOO) A:(OCOC) B:(COCO) C:Gap_Column D:Gap_Row
-std::vector<int> Generate::get_region_grid_patterns(std::set<Point> points) {
-	std::vector<int> result(14, 0);
-	for (Point p : points) {
-		if (p.first % 2 == 1 && p.second % 2 == 0 && get(p) != PATH) {
-			if (get(p) == 0x300000 || get(p) == 0x500000) {
-				result[0xD] += 1;
-			}
-			else {
-				result[0xB] += 1;
-			}
-			continue;
-		}
-		else if (p.first % 2 == 0 && p.second % 2 == 1 && get(p) != PATH) {
-			if (get(p) == 0x300000 || get(p) == 0x500000) {
-				result[0xC] += 1;
-			}
-			else {
-				result[0xA] += 1;
-			}
-			continue;
-		}
-
-		std::vector<bool> _4dir = { false,false,false,false };
-		std::vector<std::vector<bool>> data = {
-			{ true, true, false, false },
-			{ false, true, true, false },
-			{ false, false, true, true },
-			{ true, false, false, true },
-			{ false, true, true, true },
-			{ true, false, true, true },
-			{ true, true, false, true },
-			{ true, true, true, false },
-			{ true, true, true, true },
-		};
-
-		int count = 0;
-		for (Point dir : {Point(0, -1), Point(1, 0), Point(0, 1), Point(-1, 0)}) {
-			if ((p + dir).first < 0 || (p + dir).second < 0 || (p + dir).first >= _width || (p + dir).second >= _height || get(p) == PATH)
-			{
-				_4dir[count] = false;
-			}else if (get(p + dir) != PATH) {
-				_4dir[count] = true;
-			}
-			count++;
-		}
-		count = 0;
-		for (std::vector<bool> d : data) {
-			count++;
-			if (_4dir == d) {
-				result[count] += 1;
-			}
-		}
-
-	}
-	return result;
-}
-
 //Anti-triangle 
 bool Generate::place_antitriangles(int color, int amount, int target_num)
 {
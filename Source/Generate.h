@@ -7,10 +7,35 @@
 #include <time.h>
 #include <set>
 #include <algorithm>
+#include <chrono>
 #include "Random.h"
+#include "Bitboard.h"
+#include "Progress.h"
 
 typedef std::set<Point> Shape;
 
+class Pipeline;
+
+//Dots on the panel and the points around them, used when placing dots. Bit x of row y is the grid point (x, y).
+struct DotMasks {
+	Bitboard dots; //Points with a dot
+	Bitboard adjacent; //Points next to a dot (never allowed)
+	//Points diagonal to a dot or 2 spaces from one, which are only allowed some of the time.
+	//Each one is rolled for once, when the dot is added, and the ones that lose are marked here.
+	Bitboard blocked;
+	int spacedOdds; //1 in this many points 2 spaces from a dot are allowed
+};
+
+//A generated puzzle that hasn't been written to the game yet (see Generate::setDeferWrites).
+//Holds everything Generate::write would send to the game, so it can be written later with Generate::commit, or thrown away for a dry run.
+struct PanelImage {
+	int id;
+	Panel panel; //Grid, endpoints, style, path width and color mode
+	int pillarWidth; //Point::pillarWidth when the puzzle was made, since the panel's geometry depends on it
+	int config; //The config flags the puzzle was written with (for the color writes)
+	Color arrowColor, backgroundColor, successColor;
+};
+
 //The main class for generating puzzles.
 class Generate
 {
@@ -24,6 +49,11 @@ public:
 		_parity = -1;
 		colorblind = false;
 		_seed = Random::rand();
+		_attemptThreads = 0;
+		_deferWrites = false;
+		_timeBudget = 0;
+		_fallbacks = _FALLBACKS;
+		_areaMinDifficulty = _areaMaxDifficulty = _areaSolveTimeBudget = 0;
 		arrowColor = backgroundColor = successColor = { 0, 0, 0, 0 };
 		resetConfig();
 	}
@@ -34,8 +64,15 @@ public:
 		DecorationsOnly = 0x800000, FalseParity = 0x1000000, DisableDotIntersection = 0x2000000, WriteDotColor = 0x4000000, WriteDotColor2 = 0x8000000, LongestPath = 0x10000000, WriteInvisible = 0x20000000,
 		DisableReset = 0x40000000, MountainFloorH = 0x80000000
 	};
+
+	//A step down from the puzzle that was asked for, used when a puzzle runs out of time (see setTimeBudget)
+	struct Fallback {
+		int addFlags, removeFlags; //Config flags changed for the step
+		int symbolPercent; //Stones, triangles and dots are cut down to this percent of the amount asked for (at least 1 of each)
+		bool dropChecks; //Don't check the solution count or difficulty
+	};
 	
-	void generate(int id) { PuzzleSymbols symbols({ }); while (!generate(id, symbols)); }
+	void generate(int id) { run_attempts(id, PuzzleSymbols({ })); }
 	void generate(int id, int symbol, int amount);
 	void generate(int id, int symbol1, int amount1, int symbol2, int amount2);
 	void generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3);
@@ -63,8 +100,10 @@ public:
 	void setSymmetry(Panel::Symmetry symmetry);
 	void write(int id);
 	void setLoadingHandle(HWND handle) { _handle = handle; }
-	void setLoadingData(int totalPuzzles) { _totalPuzzles = totalPuzzles; _genTotal = 0; }
-	void setLoadingData(const std::wstring& areaName, int numPuzzles) { _areaName = areaName; _areaPuzzles = numPuzzles; _areaTotal = 0; }
+	void setLoadingData(int totalPuzzles) { _totalPuzzles = totalPuzzles; _genTotal = 0; if (_progress) _progress->setTotal(totalPuzzles); }
+	void setLoadingData(const std::wstring& areaName, int numPuzzles) { _areaName = areaName; _areaPuzzles = numPuzzles; _areaTotal = 0; if (_progress) _progress->setArea(areaName, numPuzzles); }
+	//Report progress here as well as to the loading handle, and stop with Progress::CancelledError between attempts once it is cancelled
+	void setProgress(std::shared_ptr<Progress> progress) { _progress = progress; }
 	void setFlag(Config option) { _config |= option; };
 	void setFlagOnce(Config option) { _config |= option; _oneTimeAdd |= option; };
 	bool hasFlag(Config option) { return _config & option; };
@@ -72,6 +111,25 @@ public:
 	void removeFlagOnce(Config option) { _config &= ~option; _oneTimeRemove |= option; };
 	void resetConfig();
 	void seed(long seed) { Random::seed(seed); _seed = Random::rand(); }
+	void setMaxSolutions(int maxSolutions, double timeBudget) { _maxSolutions = maxSolutions; _solveTimeBudget = timeBudget; }
+	//Only keep puzzles with a difficulty score (see Difficulty) between minScore and maxScore (0 for no upper limit)
+	void setDifficulty(double minScore, double maxScore, double timeBudget) { _minDifficulty = minScore; _maxDifficulty = maxScore; _solveTimeBudget = timeBudget; }
+	//Same as setDifficulty, but resetConfig goes back to it instead of clearing it, so it holds for every puzzle in the area
+	void setAreaDifficulty(double minScore, double maxScore, double timeBudget) { _areaMinDifficulty = minScore; _areaMaxDifficulty = maxScore; _areaSolveTimeBudget = timeBudget; }
+	//0 - attempts at a puzzle run one after another, continuing the same random stream (the default)
+	//Above 0 - each attempt gets its own random stream, and this many run at once. Puzzles from a given seed are the same for any number of threads.
+	void setAttemptThreads(int threads) { _attemptThreads = threads; }
+	//0 - keep making attempts at a puzzle until one succeeds (the default). Above 0 - after this many milliseconds, move down the fallback ladder, with the same time for each step.
+	//If the last step runs out of time too, the game's own puzzle is left in place (or if the puzzle isn't being written, the last step keeps going with no time limit).
+	void setTimeBudget(double milliseconds) { _timeBudget = milliseconds; }
+	void setTimeBudget(double milliseconds, const std::vector<Fallback>& fallbacks) { _timeBudget = milliseconds; _fallbacks = fallbacks; }
+	//If set, write() stores each puzzle as a PanelImage instead of writing it to the game. The images can be taken with takeImages and written with commit.
+	void setDeferWrites(bool defer) { _deferWrites = defer; }
+	std::vector<PanelImage> takeImages() { std::vector<PanelImage> images; images.swap(_images); return images; }
+	//If set, write() hands each puzzle to the pipeline to be written while the next one is generated. Puzzles with DisableReset are still written here, since the generator keeps using their panel.
+	void setPipeline(std::shared_ptr<Pipeline> pipeline) { _pipeline = pipeline; }
+	static void commit(const PanelImage& image);
+	static void commit(const std::vector<PanelImage>& images) { for (const PanelImage& image : images) commit(image); }
 	void incrementProgress();
 
 	float pathWidth; //Controls how thick the line is on the puzzle
@@ -100,10 +158,23 @@ private:
 	template <class T> T pop_random(const std::set<T>& set) { T item = pick_random(set); set.erase(item); return item; }
 	bool on_edge(Point p) { return (Point::pillarWidth == 0 && (p.first == 0 || p.first + 1 == _panel->_width) || p.second == 0 || p.second + 1 == _panel->_height); }
 	bool off_edge(Point p) { return (p.first < 0 || p.first >= _panel->_width || p.second < 0 || p.second >= _panel->_height); }
-	static std::vector<Point> _DIRECTIONS1, _8DIRECTIONS1, _DIRECTIONS2, _8DIRECTIONS2, _SHAPEDIRECTIONS, _DISCONNECT;
+	static std::vector<Point> _DIRECTIONS1, _8DIRECTIONS1, _DIRECTIONS2, _8DIRECTIONS2, _DISCONNECT;
+	static std::vector<Fallback> _FALLBACKS;
 	bool generate_maze(int id, int numStarts, int numExits);
 	bool generate(int id, PuzzleSymbols symbols); //************************************************************
+	void run_attempts(int id, const PuzzleSymbols& symbols);
+	bool make_attempts(int id, const PuzzleSymbols& symbols, std::chrono::steady_clock::time_point deadline);
+	PuzzleSymbols relax_symbols(PuzzleSymbols symbols, int percent);
+	std::chrono::steady_clock::time_point get_deadline() { return _timeBudget > 0 ? std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<long long>(_timeBudget * 1000)) : no_deadline(); }
+	static std::chrono::steady_clock::time_point no_deadline() { return (std::chrono::steady_clock::time_point::max)(); } //In parentheses to get around the max macro
+	void log_fallback(int id, const std::wstring& message);
+	void skip(int id);
+	void end_puzzle();
+	int attempt_seed(int id, int attempt);
 	bool place_all_symbols(PuzzleSymbols& symbols);
+	bool use_placement_solver(PuzzleSymbols& symbols);
+	bool place_with_solver(PuzzleSymbols& symbols);
+	bool check_solution_count(int id);
 	bool generate_path(PuzzleSymbols& symbols);
 	bool generate_path_length(int minLength, int maxLength);
 	bool generate_path_length(int minLength) { return generate_path_length(minLength, 10000); };
@@ -113,13 +184,19 @@ private:
 	void erase_path();
 	Point adjust_point(Point pos);
 	std::set<Point> get_region(Point pos);
+	const RegionKernel& get_regions(Point pos);
 	std::vector<int> get_symbols_in_region(Point pos);
 	std::vector<int> get_symbols_in_region(const std::set<Point>& region);
 	bool place_start(int amount);
 	bool place_exit(int amount);
 	bool can_place_gap(Point pos);
 	bool place_gaps(int amount);
-	bool can_place_dot(Point pos, bool intersectionOnly);
+	std::vector<std::vector<int>> get_degree_map();
+	bool makes_dead_end(Point pos, const std::vector<std::vector<int>>& degree);
+	bool dot_masks_fit() const { return _panel->_width <= Bitboard::SIZE && _panel->_height <= Bitboard::SIZE; } //The masks hold the grid points directly
+	DotMasks get_dot_masks(bool intersectionOnly);
+	void add_dot_mask(DotMasks& masks, Point pos);
+	Bitboard get_dot_spots(const DotMasks& masks);
 	bool place_dots(int amount, int color, bool intersectionOnly);
 	bool can_place_stone(const std::set<Point>& region, int color);
 	bool place_stones(int color, int amount);
@@ -134,6 +211,7 @@ private:
 	bool has_star(const std::set<Point>& region, int color);
 	bool checkStarZigzag(std::shared_ptr<Panel> panel);
 	bool place_triangles(int color, int amount, int targetCount);
+	bool next_to_endpoint(Point pos);
 	int count_sides(Point pos);
 	bool place_arrows(int color, int amount, int targetCount);
 	bool place_mines(int color, int amount, int target_num);
@@ -146,8 +224,6 @@ private:
 	bool place_ghosts(int color, int amount);
 	bool place_bars(int color, int amount,int shape);
 	void DebugLog(int i);
-	std::set<Point> get_region_points(Point pos);
-	std::vector<int> get_region_grid_patterns(std::set<Point> points);
 	bool place_antitriangles(int color, int amount, int target_num);
 	bool check_it_is_corner(Point pos);
 	bool place_darts(int color, int amount, int target_num);
@@ -177,7 +253,26 @@ private:
 	bool _allowNonMatch; //Used for multi-generator
 	int _parity;
 	std::vector<std::vector<Point>> _obstructions;
+	std::vector<Point> _shapeDirections; //Either _DIRECTIONS2 or _DISCONNECT, depending on whether shapes have to be connected
 	bool colorblind;
+	int _maxSolutions; //If above 0, puzzles with more solutions than this are thrown out
+	double _minDifficulty, _maxDifficulty; //If either is above 0, the solver scores each puzzle and ones outside the range are thrown out
+	double _solveTimeBudget; //Milliseconds the solver gets for counting solutions
+	double _areaMinDifficulty, _areaMaxDifficulty, _areaSolveTimeBudget; //See setAreaDifficulty
+	int _attemptThreads; //See setAttemptThreads
+	bool _deferWrites; //See setDeferWrites
+	std::vector<PanelImage> _images;
+	std::shared_ptr<Pipeline> _pipeline; //See setPipeline
+	double _timeBudget; //See setTimeBudget
+	std::vector<Fallback> _fallbacks;
+	std::shared_ptr<Progress> _progress; //See setProgress
+	std::map<int, std::pair<int, int>> _placementTries; //For each panel id, how many times symbols were placed and how many of those failed
+	std::set<int> _skipped; //Puzzles left as the game's own (see skip), so puzzles made from them can be left alone too
+	std::shared_ptr<RegionKernel> _regionCache[4]; //Labeled regions for each parity class of the grid (see get_regions)
+
+	static const int _SOLVER_MIN_TRIES = 50; //Panels where placing symbols fails this many times, at a rate of at least _SOLVER_REJECTION_RATE percent,
+	static const int _SOLVER_REJECTION_RATE = 95; //switch to PlacementSolver for the symbols it supports
+	static const int _SOLVER_BUDGET = 5000;
 
 	HWND _handle;
 	int _areaTotal, _genTotal, _areaPuzzles, _totalPuzzles;
@@ -128,6 +128,7 @@ void Memory::ThrowError() {
 
 void* Memory::ComputeOffset(std::vector<int> offsets)
 {
+	if (panelFence && offsets.size() > 2 && offsets[1] == 0x18) panelFence(offsets[2] / 8);
 	// Leave off the last offset, since it will be either read/write, and may not be of type unitptr_t.
 	int final_offset = offsets.back();
 	offsets.pop_back();
@@ -159,3 +160,116 @@ int Memory::globalsTests[3] = {
 	0x62B0A0, //Good Old Games
 	0x5B28C0 //Older Versions
 };
+
+thread_local WriteQueue* Memory::writeQueue = nullptr;
+thread_local std::function<void(int)> Memory::panelFence;
+std::shared_ptr<WriteBehind> Memory::writeBehind;
+
+void Memory::StartWriteBehind()
+{
+	if (std::atomic_load(&writeBehind)) return;
+	std::shared_ptr<WriteBehind> none, behind = std::make_shared<WriteBehind>();
+	std::atomic_compare_exchange_strong(&writeBehind, &none, behind); //If another thread got there first, this one is stopped again
+}
+
+void Memory::StopWriteBehind()
+{
+	//Threads still writing through it keep it alive until they are done. The last one to let go waits for the writer thread.
+	std::atomic_store(&writeBehind, std::shared_ptr<WriteBehind>());
+}
+
+void Memory::Flush(const WriteQueue& queue)
+{
+	for (const auto& [address, data] : queue.writes) {
+		if (Write(reinterpret_cast<LPVOID>(address), &data[0], data.size())) continue;
+		if (!showMsg) throw std::exception();
+		ThrowError();
+	}
+}
+
+void WriteQueue::add(uintptr_t address, const void* data, size_t size)
+{
+	const char* bytes = static_cast<const char*>(data);
+	writes.emplace_back(address, std::vector<char>(bytes, bytes + size));
+}
+
+void WriteQueue::apply(uintptr_t address, void* buffer, size_t size) const
+{
+	char* bytes = static_cast<char*>(buffer);
+	for (const auto& [start, data] : writes) {
+		uintptr_t from = start > address ? start : address;
+		uintptr_t to = start + data.size() < address + size ? start + data.size() : address + size;
+		if (from < to) memcpy(bytes + (from - address), &data[from - start], to - from);
+	}
+}
+
+WriteBehind::WriteBehind()
+{
+	_memory = std::make_shared<Memory>("witness64_d3d11.exe");
+	_stop = _failed = false;
+	_thread = std::thread(&WriteBehind::run, this);
+}
+
+WriteBehind::~WriteBehind()
+{
+	std::unique_lock<std::shared_mutex> lock(_mutex);
+	_stop = true;
+	lock.unlock();
+	_changed.notify_all();
+	_thread.join();
+	if (_failed) OutputDebugStringW(L"Write behind: stopped with writes that failed after the last flush\n");
+}
+
+bool WriteBehind::add(uintptr_t address, const void* data, size_t size)
+{
+	std::unique_lock<std::shared_mutex> lock(_mutex);
+	_pending.add(address, data, size);
+	bool failed = _failed;
+	_failed = false; //Reported here, so a flush doesn't report it again
+	lock.unlock();
+	_changed.notify_all();
+	return !failed;
+}
+
+bool WriteBehind::read(Memory* memory, LPCVOID address, LPVOID buffer, SIZE_T size)
+{
+	std::shared_lock<std::shared_mutex> lock(_mutex);
+	if (!memory->ReadProcess(address, buffer, size)) return false;
+	_writing.apply(reinterpret_cast<uintptr_t>(address), buffer, size);
+	_pending.apply(reinterpret_cast<uintptr_t>(address), buffer, size);
+	return true;
+}
+
+void WriteBehind::flush()
+{
+	std::unique_lock<std::shared_mutex> lock(_mutex);
+	_changed.wait(lock, [&] { return _pending.writes.empty() && _writing.writes.empty(); });
+	if (!_failed) return;
+	_failed = false;
+	lock.unlock();
+	if (!Memory::showMsg) throw std::exception();
+	_memory->ThrowError("Error writing to the game");
+}
+
+void WriteBehind::run()
+{
+	std::unique_lock<std::shared_mutex> lock(_mutex);
+	while (true) {
+		_changed.wait(lock, [&] { return _stop || !_pending.writes.empty(); });
+		if (_pending.writes.empty()) return; //Stopped, and everything has been written
+		_writing.writes.swap(_pending.writes);
+		lock.unlock();
+		bool failed = false;
+		for (const auto& [address, data] : _writing.writes) {
+			if (_memory->WriteProcess(reinterpret_cast<LPVOID>(address), &data[0], data.size())) continue;
+			failed = true;
+			std::wstringstream text;
+			text << L"Write behind: couldn't write " << data.size() << L" bytes at 0x" << std::hex << address << L"\n";
+			OutputDebugStringW(text.str().c_str());
+		}
+		lock.lock();
+		if (failed) _failed = true;
+		_writing.writes.clear();
+		_changed.notify_all();
+	}
+}
@@ -1,11 +1,48 @@
 #pragma once
+#include <condition_variable>
 #include <functional>
 #include <map>
+#include <memory>
+#include <shared_mutex>
+#include <thread>
 #include <vector>
 #include <sstream>
 #include <iomanip>
 #include <fstream>
 #include <windows.h>
+
+//Game writes held back to be made later, in order (see TaskGraph)
+struct WriteQueue {
+	void add(uintptr_t address, const void* data, size_t size);
+	void apply(uintptr_t address, void* buffer, size_t size) const; //Copy the held back bytes that overlap a read over what was read, oldest first
+
+	std::vector<std::pair<uintptr_t, std::vector<char>>> writes;
+};
+
+class Memory;
+
+//Game writes made by a thread of its own, in the order they were queued, so the threads generating puzzles don't wait on the game (see Memory::StartWriteBehind)
+class WriteBehind {
+public:
+	WriteBehind();
+	~WriteBehind();
+
+	bool add(uintptr_t address, const void* data, size_t size); //Returns false if one of the earlier writes failed, so the next writer hears about it
+	bool read(Memory* memory, LPCVOID address, LPVOID buffer, SIZE_T size); //Read from the game, with the writes that haven't been made yet copied over it
+	void flush(); //Wait until every write queued so far is in the game. Throws if any of them failed.
+
+private:
+	void run();
+
+	std::shared_ptr<Memory> _memory;
+	WriteQueue _pending; //Not picked up by the thread yet
+	WriteQueue _writing; //Being made by the thread right now
+	std::shared_mutex _mutex; //Reads share it, so a write can't leave _writing in the middle of a read
+	std::condition_variable_any _changed;
+	bool _stop, _failed;
+	std::thread _thread;
+};
+
 // https://github.com/erayarslan/WriteProcessMemory-Example
 // http://stackoverflow.com/q/32798185
 // http://stackoverflow.com/q/36018838
@@ -32,23 +69,20 @@ public:
 	}
 
 	bool Read(LPCVOID lpBaseAddress, LPVOID lpBuffer, SIZE_T nSize) {
-		if (!retryOnFail) return ReadProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr);
-		for (int i = 0; i < 10000; i++) {
-			if (ReadProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr)) {
-				return true;
-			}
-		}
-		return false;
+		std::shared_ptr<WriteBehind> behind = std::atomic_load(&writeBehind);
+		if (!(behind ? behind->read(this, lpBaseAddress, lpBuffer, nSize) : ReadProcess(lpBaseAddress, lpBuffer, nSize))) return false;
+		if (writeQueue) writeQueue->apply(reinterpret_cast<uintptr_t>(lpBaseAddress), lpBuffer, nSize); //This thread should see the writes it is holding back
+		return true;
 	}
 
 	bool Write(LPVOID lpBaseAddress, LPCVOID lpBuffer, SIZE_T nSize) {
-		if (!retryOnFail) return WriteProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr);
-		for (int i = 0; i < 10000; i++) {
-			if (WriteProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr)) {
-				return true;
-			}
+		if (writeQueue) {
+			writeQueue->add(reinterpret_cast<uintptr_t>(lpBaseAddress), lpBuffer, nSize);
+			return true;
 		}
-		return false;
+		std::shared_ptr<WriteBehind> behind = std::atomic_load(&writeBehind);
+		if (behind) return behind->add(reinterpret_cast<uintptr_t>(lpBaseAddress), lpBuffer, nSize);
+		return WriteProcess(lpBaseAddress, lpBuffer, nSize);
 	}
 
 	template <class T>
@@ -99,6 +133,18 @@ public:
 	}
 
 	void ClearOffsets() { _computedAddresses = std::map<uintptr_t, uintptr_t>(); }
+	void Flush(const WriteQueue& queue); //Make the writes that were held back, in order
+
+	static thread_local WriteQueue* writeQueue; //If set, writes from this thread go here instead of to the game
+	static thread_local std::function<void(int)> panelFence; //If set, called with the panel before this thread reads or writes a panel's data (see Pipeline)
+
+	//From here on, writes from every thread are queued and made in order by a writer thread.
+	//If one of those writes fails, the next write from any thread fails, or FlushWrites throws if that comes first.
+	static void StartWriteBehind();
+	//Wait for the queued writes to reach the game, e.g. before starting watchdogs that expect the panels to be there
+	static void FlushWrites() { std::shared_ptr<WriteBehind> behind = std::atomic_load(&writeBehind); if (behind) behind->flush(); }
+	//Make the queued writes and stop the writer thread, when the randomizer closes. Writes after this go straight to the game.
+	static void StopWriteBehind();
 
 	static int GLOBALS;
 	static bool showMsg;
@@ -106,6 +152,26 @@ public:
 	bool retryOnFail = true;
 
 private:
+	bool ReadProcess(LPCVOID lpBaseAddress, LPVOID lpBuffer, SIZE_T nSize) {
+		if (!retryOnFail) return ReadProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr);
+		for (int i = 0; i < 10000; i++) {
+			if (ReadProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool WriteProcess(LPVOID lpBaseAddress, LPCVOID lpBuffer, SIZE_T nSize) {
+		if (!retryOnFail) return WriteProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr);
+		for (int i = 0; i < 10000; i++) {
+			if (WriteProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
 	template<class T>
 	std::vector<T> ReadData(const std::vector<int>& offsets, size_t numItems) {
 		std::vector<T> data;
@@ -137,6 +203,9 @@ private:
 	uintptr_t _baseAddress = 0;
 	HANDLE _handle = nullptr;
 
+	static std::shared_ptr<WriteBehind> writeBehind; //Only touched with std::atomic_load/atomic_store, since watchdog threads may be writing through it while it starts or stops
+
 	friend class Randomizer;
+	friend class WriteBehind;
 	friend class Special;
 };
\ No newline at end of file
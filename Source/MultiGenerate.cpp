@@ -6,62 +6,84 @@
 
 inline Point operator+(const Point& l, const Point& r) { return { l.first + r.first, l.second + r.second }; }
 
-void MultiGenerate::generate(int id, const std::vector<std::shared_ptr<Generate>>& gens, const std::vector<std::pair<int, int>>& symbolVec)
+bool MultiGenerate::generate(int id, const std::vector<std::shared_ptr<Generate>>& gens, const std::vector<std::pair<int, int>>& symbolVec,
+	std::chrono::steady_clock::time_point deadline, std::shared_ptr<Progress> progress)
 {
 	generators = gens;
 	PuzzleSymbols symbols(symbolVec);
-	while (!generate(id, symbols));
+	while (!generate(id, symbols)) {
+		if (progress) progress->checkCancelled();
+		if (std::chrono::steady_clock::now() >= deadline) return false;
+	}
+	return true;
 }
 
 bool MultiGenerate::generate(int id, PuzzleSymbols symbols)
 {
-	for (std::shared_ptr<Generate> g : generators) {
-		g->initPanel(id);
+	//Reading the panels touches the game's memory, so that part stays on this thread
+	for (std::shared_ptr<Generate> g : generators) g->initPanel(id);
+
+	//Each path gets its own random stream seeded from this one, so the paths don't depend on each other.
+	//They are made one after another: the only multi-solution panels have three short paths, which take less time than starting a thread for each would.
+	std::vector<int> seeds;
+	for (size_t i = 0; i < generators.size(); i++) seeds.push_back(Random::rand());
+	std::mt19937 stream = Random::gen;
+	bool found = true;
+	for (size_t i = 0; i < generators.size() && found; i++) {
+		Random::seed(seeds[i]);
+		PuzzleSymbols pathSymbols = symbols;
+		found = generate_path(i, pathSymbols);
+	}
+	Random::gen = stream;
+	if (!found)
+		return false;
+
+	//Only the paths that don't fit with the ones before them are made again
+	for (size_t i = 1; i < generators.size(); i++) {
 		int fails = 0;
-		while (!g->generate_path(symbols)) {
-			if (fails++ > 20)
+		while (!is_compatible(i)) {
+			if (fails++ > 20 || !generate_path(i, symbols))
 				return false;
 		}
 	}
 
-	std::vector<std::string> solution1; //For debugging only
-	for (int y = 0; y < generators[0]->_panel->_height; y++) {
-		std::string row;
-		for (int x = 0; x < generators[0]->_panel->_width; x++) {
-			if (generators[0]->get(x, y) == PATH) {
-				row += "xx";
-			}
-			else row += "    ";
-		}
-		solution1.push_back(row);
+	build_planes();
+	if (!place_all_symbols(symbols))
+		return false;
+
+	if (!generators[0]->hasFlag(Generate::Config::DisableWrite)) generators[0]->write(id);
+	return true;
+}
+
+bool MultiGenerate::generate_path(size_t index, PuzzleSymbols& symbols)
+{
+	int fails = 0;
+	while (!generators[index]->generate_path(symbols)) {
+		if (fails++ > 20)
+			return false;
 	}
-	std::vector<std::string> solution2; //For debugging only
-	for (int y = 0; y < generators[1]->_panel->_height; y++) {
-		std::string row;
-		for (int x = 0; x < generators[1]->_panel->_width; x++) {
-			if (generators[1]->get(x, y) == PATH) {
-				row += "xx";
+	return true;
+}
+
+//Check a path against the paths of the generators before it. Generators with the same starts have to use the same start,
+//generators with the same exits have to use different ones (if there are enough to go around), and no two paths can be the same.
+bool MultiGenerate::is_compatible(size_t index)
+{
+	std::shared_ptr<Generate> g = generators[index];
+	for (size_t i = 0; i < index; i++) {
+		std::shared_ptr<Generate> other = generators[i];
+		if (other->_path == g->_path) return false;
+		if (other->_starts == g->_starts) {
+			for (Point p : g->_starts) {
+				if (g->_path.count(p) != other->_path.count(p)) return false;
 			}
-			else row += "    ";
 		}
-		solution2.push_back(row);
-	}
-	std::vector<std::string> solution3; //For debugging only
-	for (int y = 0; y < generators[2]->_panel->_height; y++) {
-		std::string row;
-		for (int x = 0; x < generators[2]->_panel->_width; x++) {
-			if (generators[2]->get(x, y) == PATH) {
-				row += "xx";
+		if (other->_exits == g->_exits && g->_exits.size() >= generators.size()) {
+			for (Point p : g->_exits) {
+				if (g->_path.count(p) && other->_path.count(p)) return false;
 			}
-			else row += "    ";
 		}
-		solution3.push_back(row);
 	}
-
-	if (!place_all_symbols(symbols))
-		return false;
-
-	if (!generators[0]->hasFlag(Generate::Config::DisableWrite)) generators[0]->write(id);
 	return true;
 }
 
@@ -92,18 +114,22 @@ bool MultiGenerate::place_stones(int color, int amount)
 		if (open.size() < amount)
 			return false;
 		Point pos = pick_random(open);
-		bool valid = true;
-		for (std::shared_ptr<Generate> g : generators) {
-			std::set<Point> region = g->get_region(pos);
-			if (!g->can_place_stone(region, color)) {
-				for (Point p : region) open.erase(p);
-				valid = false;
+		std::vector<std::vector<uint32_t>> regions = get_regions(pos);
+		//Paths where the stone would share a region with a stone of another color
+		uint32_t blocked = 0;
+		for (int x = 1; x < generators[0]->_panel->_width; x += 2) {
+			for (int y = 1; y < generators[0]->_panel->_height; y += 2) {
+				int sym = generators[0]->get(x, y);
+				if (regions[x][y] && generators[0]->get_symbol_type(sym) == Decoration::Stone && (sym & 0xf) != color) blocked |= regions[x][y];
 			}
-			else if (splitStones) {
-				for (Point p : region) open.erase(p);
+		}
+		uint32_t erase = splitStones ? _allPaths : blocked;
+		for (int x = 1; x < generators[0]->_panel->_width; x += 2) {
+			for (int y = 1; y < generators[0]->_panel->_height; y += 2) {
+				if (regions[x][y] & erase) open.erase(Point(x, y));
 			}
 		}
-		if (!valid) continue;
+		if (blocked) continue;
 		for (std::shared_ptr<Generate> g : generators) {
 			g->set(pos, Decoration::Stone | color);
 			g->_openpos.erase(pos);
@@ -123,35 +149,54 @@ bool MultiGenerate::place_stars(int color, int amount)
 		if (open.size() < amount)
 			return false;
 		Point pos = pick_random(open);
-		std::vector<std::set<Point>> regions;
+		std::vector<std::vector<uint32_t>> regions = get_regions(pos);
+		//Count the cells and symbols of this color in every path's region at once, saturating at three
+		uint32_t cells1 = 0, cells2 = 0, color1 = 0, color2 = 0, color3 = 0, star = 0;
+		for (int x = 1; x < generators[0]->_panel->_width; x += 2) {
+			for (int y = 1; y < generators[0]->_panel->_height; y += 2) {
+				uint32_t in = regions[x][y];
+				if (!in) continue;
+				cells2 |= cells1 & in;
+				cells1 |= in;
+				int sym = generators[0]->get(x, y);
+				if (!sym || (sym & 0xf) != color) continue;
+				color3 |= color2 & in;
+				color2 |= color1 & in;
+				color1 |= in;
+				if (sym == (Decoration::Star | color)) star |= in;
+			}
+		}
+		uint32_t erase = 0, matched = 0;
 		std::vector<std::shared_ptr<Generate>> nonMatch;
-		for (std::shared_ptr<Generate> g : generators) {
-			std::set<Point> region = g->get_region(pos);
-			if (region.size() == 1) {
-				for (Point p : region) open.erase(p);
+		for (size_t i = 0; i < generators.size(); i++) {
+			std::shared_ptr<Generate> g = generators[i];
+			uint32_t bit = 1u << i;
+			if (!(cells2 & bit)) { //The region is just this cell
+				erase |= bit;
 				continue;
 			}
-			int count = g->count_color(region, color);
-			if (count == 0) {
-				if (amount <= halfPoint || amount == halfPoint + 1 && g->_allowNonMatch)
-					for (Point p : region) open.erase(p);
-				else regions.push_back(region);
+			if (!(color1 & bit)) {
+				if (amount <= halfPoint || amount == halfPoint + 1 && g->_allowNonMatch) erase |= bit;
+				else matched |= bit;
 			}
-			else if (count == 1) {
-				if (amount <= halfPoint && !g->has_star(region, color) || amount > halfPoint && (!g->_allowNonMatch || g->has_star(region, color)))
-					for (Point p : region) open.erase(p);
+			else if (!(color2 & bit)) {
+				bool hasStar = (star & bit) != 0;
+				if (amount <= halfPoint && !hasStar || amount > halfPoint && (!g->_allowNonMatch || hasStar)) erase |= bit;
 				else {
-					regions.push_back(region);
+					matched |= bit;
 					if (amount > halfPoint) nonMatch.push_back(g);
 				}
 			}
-			else {
-				for (Point p : region) open.erase(p);
+			else erase |= bit;
+		}
+		if (matched == _allPaths) erase |= matched;
+		for (int x = 1; x < generators[0]->_panel->_width; x += 2) {
+			for (int y = 1; y < generators[0]->_panel->_height; y += 2) {
+				if (regions[x][y] & erase) open.erase(Point(x, y));
 			}
 		}
-		if (regions.size() < generators.size()) continue;
+		if (matched != _allPaths) continue;
 		for (std::shared_ptr<Generate> g : nonMatch) g->_allowNonMatch = false;
-		for (std::set<Point>& region : regions) for (Point p : region) open.erase(p);
 		for (std::shared_ptr<Generate> g : generators) {
 			g->set(pos, Decoration::Star | color);
 			g->_openpos.erase(pos);
@@ -164,12 +209,7 @@ bool MultiGenerate::place_stars(int color, int amount)
 
 bool MultiGenerate::can_place_triangle(Point pos)
 {
-	int count = generators[0]->count_sides(pos);
-	if (count == 0) return false;
-	for (int i = 1; i < generators.size(); i++) {
-		if (generators[i]->count_sides(pos) != count) return false;
-	}
-	return true;
+	return count_sides(pos) > 0;
 }
 
 bool MultiGenerate::place_triangles(int color, int amount)
@@ -186,7 +226,7 @@ bool MultiGenerate::place_triangles(int color, int amount)
 			return false;
 		Point pos = pick_random(open);
 		open.erase(pos);
-		int count = generators[0]->count_sides(pos);
+		int count = count_sides(pos);
 		for (std::shared_ptr<Generate> g : generators) {
 			g->set(pos, Decoration::Triangle | (count << 16) | color);
 			g->_openpos.erase(pos);
@@ -195,3 +235,80 @@ bool MultiGenerate::place_triangles(int color, int amount)
 	}
 	return true;
 }
+
+void MultiGenerate::build_planes()
+{
+	std::shared_ptr<Panel> panel = generators[0]->_panel;
+	_onPath.assign(panel->_width, std::vector<uint32_t>(panel->_height, 0));
+	_allPaths = generators.size() >= 32 ? ~0u : (1u << generators.size()) - 1;
+	for (size_t i = 0; i < generators.size(); i++) {
+		for (int x = 0; x < panel->_width; x++) {
+			for (int y = 0; y < panel->_height; y++) {
+				if (generators[i]->get(x, y) == PATH) _onPath[x][y] |= 1u << i;
+			}
+		}
+	}
+}
+
+//Find the region around pos for every path with a single flood fill. Bit i of each cell is set if path i puts it in the same region as pos.
+//Follows the same rules as Generate::get_region.
+std::vector<std::vector<uint32_t>> MultiGenerate::get_regions(Point pos)
+{
+	std::shared_ptr<Panel> panel = generators[0]->_panel;
+	std::vector<std::vector<uint32_t>> regions(panel->_width, std::vector<uint32_t>(panel->_height, 0));
+	std::vector<Point> queue = { pos };
+	regions[pos.first][pos.second] = _allPaths;
+	const int DIRECTIONS[4][2] = { { 0, 1 }, { 0, -1 }, { 1, 0 }, { -1, 0 } };
+	while (queue.size()) {
+		Point cell = queue.back();
+		queue.pop_back();
+		for (int d = 0; d < 4; d++) {
+			int ex = cell.first + DIRECTIONS[d][0], ey = cell.second + DIRECTIONS[d][1];
+			int tx = cell.first + DIRECTIONS[d][0] * 2, ty = cell.second + DIRECTIONS[d][1] * 2;
+			if (Point::pillarWidth) {
+				ex = (ex + panel->_width) % panel->_width;
+				tx = (tx + panel->_width) % panel->_width;
+			}
+			uint32_t open;
+			if (tx < 0 || ty < 0 || tx >= panel->_width || ty >= panel->_height || !can_cross(ex, ey, open)) continue;
+			if ((generators[0]->get(tx, ty) & Decoration::Empty) == Decoration::Empty) continue;
+			uint32_t spread = regions[cell.first][cell.second] & open & ~regions[tx][ty];
+			if (!spread) continue;
+			regions[tx][ty] |= spread;
+			queue.push_back(Point(tx, ty));
+		}
+	}
+	return regions;
+}
+
+//Whether the edge (x, y) can be crossed by a region at all. open is set to the paths that don't go through it.
+bool MultiGenerate::can_cross(int x, int y, uint32_t& open)
+{
+	std::shared_ptr<Panel> panel = generators[0]->_panel;
+	if (!Point::pillarWidth && (x == 0 || x + 1 == panel->_width) || y == 0 || y + 1 == panel->_height) return false;
+	if (generators[0]->get(x, y) == OPEN) return false;
+	open = _allPaths & ~_onPath[x][y];
+	return open != 0;
+}
+
+//Number of sides of the block at pos that every path goes along, or 0 if the paths don't agree.
+//The four sides are added up as bitplanes, so the count for every path comes out of the same few operations.
+int MultiGenerate::count_sides(Point pos)
+{
+	std::shared_ptr<Panel> panel = generators[0]->_panel;
+	uint32_t sides[4] = { 0, 0, 0, 0 };
+	const int DIRECTIONS[4][2] = { { 0, 1 }, { 0, -1 }, { 1, 0 }, { -1, 0 } };
+	for (int d = 0; d < 4; d++) {
+		int x = pos.first + DIRECTIONS[d][0], y = pos.second + DIRECTIONS[d][1];
+		if (Point::pillarWidth) x = (x + panel->_width) % panel->_width;
+		if (x >= 0 && y >= 0 && x < panel->_width && y < panel->_height) sides[d] = _onPath[x][y];
+	}
+	uint32_t sum01 = sides[0] ^ sides[1], carry01 = sides[0] & sides[1];
+	uint32_t sum23 = sides[2] ^ sides[3], carry23 = sides[2] & sides[3];
+	uint32_t ones = sum01 ^ sum23, carry = sum01 & sum23;
+	uint32_t twos = carry01 ^ carry23 ^ carry, fours = carry01 & carry23 | carry01 & carry | carry23 & carry;
+	for (uint32_t plane : { ones, twos, fours }) {
+		if (plane != 0 && plane != _allPaths) return 0;
+	}
+	return (ones & 1) + (twos & 1) * 2 + (fours & 1) * 4;
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "Generate.h"
 #include "Random.h"
+#include <stdint.h>
 
 //Class for generating puzzles with multiple solutions.
 class MultiGenerate
@@ -12,19 +13,32 @@ public:
 
 	std::vector<std::shared_ptr<Generate>> generators;
 
-	void generate(int id, const std::vector<std::shared_ptr<Generate>>& gens, const std::vector<std::pair<int, int>>& symbolVec);
+	//Keep making attempts until one succeeds (and return true), or until the deadline (and return false). Stops with Progress::CancelledError once progress is cancelled.
+	bool generate(int id, const std::vector<std::shared_ptr<Generate>>& gens, const std::vector<std::pair<int, int>>& symbolVec,
+		std::chrono::steady_clock::time_point deadline, std::shared_ptr<Progress> progress);
 
 	bool splitStones;
 
 private:
 
 	bool generate(int id, PuzzleSymbols symbols);
+	bool generate_path(size_t index, PuzzleSymbols& symbols);
+	bool is_compatible(size_t index);
 	bool place_all_symbols(PuzzleSymbols symbols);
 	bool can_place_gap(Point pos);
 	bool place_stones(int color, int amount);
 	bool place_stars(int color, int amount);
 	bool can_place_triangle(Point pos);
 	bool place_triangles(int color, int amount);
+	void build_planes();
+	std::vector<std::vector<uint32_t>> get_regions(Point pos);
+	int count_sides(Point pos);
+	bool can_cross(int x, int y, uint32_t& open);
+
+	//Bitplanes of the solution paths: bit i of a point is set if generator i's path goes through it.
+	//Lets the symbol checks work on every path at once, instead of one generator at a time.
+	std::vector<std::vector<uint32_t>> _onPath;
+	uint32_t _allPaths;
 
 	template <class T> T pick_random(std::vector<T>& vec) { return vec[Random::rand() % vec.size()]; }
 	template <class T> T pick_random(std::set<T>& set) { auto it = set.begin(); std::advance(it, Random::rand() % set.size()); return *it; }
@@ -10,9 +10,9 @@
 #include <sstream>
 #include <fstream>
 
-int Point::pillarWidth = 0;
 std::vector<Panel> Panel::generatedPanels;
 std::vector<std::tuple<int, int>> Panel::customSymbolPuzzles;
+std::mutex Panel::registryMutex;
 
 template <class T>
 int find(const std::vector<T> &data, T search, size_t startIndex = 0) {
@@ -92,6 +92,7 @@ void Panel::Write() {
 	_memory->WritePanelData<int>(id, STYLE_FLAGS, { _style });
 	if (pathWidth != 1) _memory->WritePanelData<float>(id, PATH_WIDTH_SCALE, { pathWidth });
 	_memory->WritePanelData<int>(id, NEEDS_REDRAW, { 1 });
+	std::lock_guard<std::mutex> lock(registryMutex);
 	generatedPanels.push_back(*this);
 }
 
@@ -326,6 +327,7 @@ void Panel::WriteDecorations() {
 		_memory->WriteArray<int>(id, DECORATION_FLAGS, decorations);
 	}
 	if (custom) {
+		std::lock_guard<std::mutex> lock(registryMutex);
 		customSymbolPuzzles.emplace_back(id, Point::pillarWidth);
 	}
 }
@@ -335,6 +337,7 @@ void Panel::StartSymbolWatchdogs(const std::map<int, int>& shuffleMappings) {
 	for (const auto& [from, to] : shuffleMappings) {
 		invertedMappings[to] = from;
 	}
+	std::lock_guard<std::mutex> lock(registryMutex);
 	for (const auto& [id, pillarWidth] : customSymbolPuzzles) {
 		int realId = id;
 		if (invertedMappings.count(realId)) realId = invertedMappings.at(realId);
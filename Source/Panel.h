@@ -1,151 +1,11 @@
 #pragma once
+#include "GridTypes.h"
 #include "Memory.h"
 #include "Randomizer.h"
+#include <mutex>
 #include <stdint.h>
 #include <tuple>
 
-struct Point {
-	int first;
-	int second;
-	Point() { first = 0; second = 0; };
-	Point(int x, int y) { if (pillarWidth) first = (x + pillarWidth) % pillarWidth; else first = x; second = y; }
-	Point operator+(const Point& p) { return { first + p.first, second + p.second }; }
-	Point operator*(int d) { return { first * d, second * d }; }
-	Point operator/(int d) { return { first / d, second / d }; }
-	bool operator==(const Point& p) const { return first == p.first && second == p.second; };
-	bool operator!=(const Point& p) const { return first != p.first || second != p.second; };
-	friend bool operator<(const Point& p1, const Point& p2) { if (p1.first == p2.first) return p1.second < p2.second; return p1.first < p2.first; };
-	static int pillarWidth;
-};
-
-class Decoration
-{
-public:
-	enum Shape : int {
-		Exit =		0x600001,
-		Start =		0x600002,
-		Stone =		0x100,//Start of Symbols
-		Star =		0x200,
-		Poly =		0x400,
-		Eraser =	0x500,
-		Triangle =	0x600,
-		Triangle1 = 0x10600,
-		Triangle2 = 0x20600,
-		Triangle3 = 0x30600,
-		Triangle4 = 0x40600,
-		Arrow =		0x700,
-		Arrow1 = 0x1700,
-		Arrow2 = 0x2700,
-		Arrow3 = 0x3700,
-		Can_Rotate = 0x1000,
-		Negative = 0x2000,//End of SymbolsW
-		Gap = 0x100000,
-		Gap_Row = 0x300000,
-		Gap_Column = 0x500000,
-		Dot = 0x20,
-		Dot_Row = 0x240020,
-		Dot_Column = 0x440020,
-		Dot_Intersection = 0x600020,
-		Mine = 0x1000000,
-		Mine1 = 0x1010000,
-		Mine2 = 0x1020000,
-		Mine3 = 0x1030000,
-		Mine4 = 0x1040000,
-		Mine5 = 0x1050000,
-		Mine6 = 0x1060000,
-		Mine7 = 0x1070000,
-		Mine8 = 0x1080000,
-		Mine9 = 0x1090000,
-		Head = 0x2000000,
-		Mushroom = 0x3000000,
-		Ghost = 0x4000000,
-		Bar = 0x5000000,
-		BarUR = 0x5010000,
-		BarDR = 0x5020000,
-		BarDL = 0x5030000,
-		BarUL = 0x5040000,
-		BarTD = 0x5050000,
-		BarTL = 0x5060000,
-		BarTU = 0x5070000,
-		BarTR = 0x5080000,
-		BarPlus = 0x5090000,
-		BarV = 0x50A0000,
-		BarH = 0x50B0000,
-		Antitriangle = 0x6000000,
-		Antitriangle1 = 0x6010000,
-		Antitriangle2 = 0x6020000,
-		Antitriangle3 = 0x6030000,
-		Antitriangle4 = 0x6040000,
-		Dart = 0x7000000,
-		Dart1 = 0x7010000,
-		Dart2 = 0x7020000,
-		Dart3 = 0x7030000,
-		Dart4 = 0x7040000,
-		Rain = 0x8000000,
-		RainD = 0x8010000,
-		RainU = 0x8020000,
-		RainR = 0x8030000,
-		RainL = 0x8040000,
-		Pointer = 0x9000000,
-		Diamond = 0xA000000,
-		Diamond0 = 0xA010000,
-		Diamond1 = 0xA020000,
-		Diamond2 = 0xA030000,
-		Diamond3 = 0xA040000,
-		Diamond4 = 0xA050000,
-		Dice = 0xB000000,
-		Dice1 = 0xB010000,
-		Dice2 = 0xB020000,
-		Dice3 = 0xB030000,
-		Dice4 = 0xB040000,
-		Dice5 = 0xB050000,
-		Dice6 = 0xB060000,
-		Bell = 0xC000000,
-		BellD = 0xC010000,
-		BellL = 0xC020000,
-		BellU = 0xC030000,
-		BellR = 0xC040000,
-		Tent = 0xD000000,
-		Circle = 0xE000000,
-		NewSymbolsF = 0xF000000,
-
-		Empty = 0xA00,
-	};
-	enum Color : int {
-		None = 0,
-		Black = 0x1,
-		White = 0x2,
-		Red =	0x3, //Doesn't work sadly
-		Purple = 0x4,
-		Green = 0x5,
-		Cyan = 0x6,
-		Magenta = 0x7,
-		Yellow = 0x8,
-		Blue = 0x9,
-		Orange = 0xA,
-		X = 0xF,
-	};
-};
-
-enum IntersectionFlags : int {
-	ROW = 0x200000,
-	COLUMN = 0x400000,
-	INTERSECTION = 0x600000,
-	ENDPOINT = 0x1,
-	STARTPOINT = 0x2,
-	OPEN = 0x3, //Puzzle loader flag - not to be written out
-	PATH = 0x4, //Generator use only
-	NO_POINT = 0x8, //Points that nothing connects to
-	GAP = 0x100000,
-	DOT = 0x20,
-	DOT_IS_BLUE = 0x100,
-	DOT_IS_ORANGE = 0x200,
-	DOT_IS_INVISIBLE = 0x1000,
-	DOT_SMALL = 0x2000,
-	DOT_MEDIUM = 0x4000,
-	DOT_LARGE = 0x8000,
-};
-
 class Endpoint {
 public:
 	enum Direction {
@@ -498,6 +358,7 @@ private:
 
 	static std::vector<Panel> generatedPanels;
 	static std::vector<std::tuple<int, int>> customSymbolPuzzles;
+	static std::mutex registryMutex; //For the two lists above, since panels can be written from more than one thread
 
 	friend class PanelExtractionTests;
 	friend class Generate;
@@ -505,4 +366,5 @@ private:
 	friend class Special;
 	friend class MultiGenerate;
 	friend class SymbolWatchdog;
+	friend class Speculation;
 };
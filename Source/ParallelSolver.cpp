@@ -0,0 +1,94 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "ParallelSolver.h"
+#include <thread>
+
+ParallelSolver::ParallelSolver(const Solver& solver, int numThreads) : _solver(solver)
+{
+	if (numThreads <= 0) numThreads = static_cast<int>(std::thread::hardware_concurrency());
+	_numThreads = numThreads > 0 ? numThreads : 1;
+	_stats = SolverStats();
+}
+
+int ParallelSolver::count_solutions(int limit, double timeBudget)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	//Find a split length that leaves enough tasks to keep every thread busy
+	SolverStats total = SolverStats();
+	size_t depth = _SPLIT_STEP;
+	while (true) {
+		_solver.split(depth, limit, timeBudget);
+		if (_solver.stopped() || _solver._tasks.empty() || _solver._tasks.size() >= _TASKS_PER_THREAD * _numThreads || depth >= _MAX_SPLIT_DEPTH) break;
+		depth += _SPLIT_STEP;
+	}
+	add_stats(total, _solver._stats); //Each split searches the same lines as the last one, so only the final one counts
+	std::atomic<int> solutions(_solver._stats.solutions);
+	if (!_solver.stopped() && _solver._tasks.size()) {
+		_queues.clear();
+		for (int i = 0; i < _numThreads; i++) _queues.push_back(std::make_shared<TaskQueue>());
+		for (size_t i = 0; i < _solver._tasks.size(); i++) _queues[i % _numThreads]->tasks.push_back(_solver._tasks[i]);
+		auto deadline = startTime + std::chrono::microseconds(static_cast<long long>(timeBudget * 1000));
+		std::vector<Solver> solvers(_numThreads, _solver);
+		std::vector<std::thread> threads;
+		for (int i = 0; i < _numThreads; i++) {
+			solvers[i]._tasks.clear();
+			solvers[i].begin(limit, timeBudget, false);
+			solvers[i]._deadline = deadline;
+			solvers[i]._sharedSolutions = &solutions;
+			threads.emplace_back(&ParallelSolver::work, this, std::ref(solvers[i]), static_cast<size_t>(i));
+		}
+		for (std::thread& thread : threads) thread.join();
+		for (const Solver& solver : solvers) add_stats(total, solver._stats);
+	}
+	_solver._tasks.clear();
+	int count = solutions.load();
+	if (limit && count > limit) count = limit; //Threads that find a solution at the same time can go over
+	total.solutions = count;
+	total.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	_stats = total;
+	return count;
+}
+
+//Add up the search counts from one part of the search. Solutions are counted separately, since the threads share them.
+void ParallelSolver::add_stats(SolverStats& total, const SolverStats& stats)
+{
+	total.nodes += stats.nodes;
+	total.timedOut = total.timedOut || stats.timedOut;
+	total.moves += stats.moves;
+	total.expandedNodes += stats.expandedNodes;
+	total.forcedNodes += stats.forcedNodes;
+	total.deadEnds += stats.deadEnds;
+	total.deadEndLength += stats.deadEndLength;
+	total.solutionLength += stats.solutionLength;
+}
+
+void ParallelSolver::work(Solver& solver, size_t index)
+{
+	Point::pillarWidth = solver._pillarWidth;
+	std::vector<Point> task;
+	while (!solver.stopped() && take(index, task)) {
+		solver.search_from(task);
+	}
+}
+
+//Take the newest task from this thread's own queue, or else steal the oldest one from another thread
+bool ParallelSolver::take(size_t index, std::vector<Point>& task)
+{
+	for (size_t i = 0; i < _queues.size(); i++) {
+		TaskQueue& queue = *_queues[(index + i) % _queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty()) continue;
+		if (i == 0) {
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else {
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "Solver.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//Runs a Solver's search on several threads.
+//The search is first cut off at a fixed length, and each partial line left over becomes a task that continues the search from there.
+//Tasks are dealt out to the threads, and a thread that runs out of its own work steals from the others, so uneven subtrees don't leave threads idle.
+//Every thread works on its own copy of the solver, and they share only the solution count and the deadline.
+class ParallelSolver {
+public:
+	//solver - a Solver already set up for the panel (including symmetry), numThreads - 0 to use one per hardware thread
+	ParallelSolver(const Solver& solver, int numThreads);
+
+	//Same as Solver::count_solutions
+	int count_solutions(int limit, double timeBudget);
+
+	const SolverStats& get_stats() const { return _stats; }
+
+private:
+	struct TaskQueue {
+		std::mutex mutex;
+		std::deque<std::vector<Point>> tasks;
+	};
+
+	void work(Solver& solver, size_t index);
+	bool take(size_t index, std::vector<Point>& task);
+	static void add_stats(SolverStats& total, const SolverStats& stats);
+
+	Solver _solver;
+	int _numThreads;
+	std::vector<std::shared_ptr<TaskQueue>> _queues;
+	SolverStats _stats;
+
+	static const size_t _TASKS_PER_THREAD = 16;
+	static const size_t _SPLIT_STEP = 4; //Points added to the split length each time there aren't enough tasks
+	static const size_t _MAX_SPLIT_DEPTH = 64;
+};
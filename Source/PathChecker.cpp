@@ -0,0 +1,171 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "PathChecker.h"
+
+PathChecker::PathChecker(const std::vector<std::vector<int>>& grid, int pillarWidth)
+{
+	_grid = _pathGrid = grid;
+	_width = static_cast<int>(grid.size());
+	_height = static_cast<int>(grid[0].size());
+	_pillarWidth = pillarWidth;
+	_hasErasers = _hasGhosts = _hasRegionSymbols = false;
+	_violations = 0;
+	_watchers.assign(_width, std::vector<std::vector<int>>(_height));
+	for (int x = 1; x < _width; x += 2) {
+		for (int y = 1; y < _height; y += 2) {
+			int symbol = grid[x][y];
+			int custom = symbol & 0xF000000, type = symbol & 0xF00;
+			if (custom == Decoration::Ghost) _hasGhosts = true;
+			if (custom == Decoration::Ghost || custom == Decoration::Dice || custom == Decoration::Diamond) _hasRegionSymbols = true;
+			if (custom) continue;
+			if (type == Decoration::Stone || type == Decoration::Star || type == Decoration::Poly || type == Decoration::Triangle) _hasRegionSymbols = true;
+			if (type == Decoration::Eraser) _hasErasers = true;
+			if (type == Decoration::Arrow) add_ray(x, y, symbol);
+		}
+	}
+	if (_hasErasers) return; //Triangles could be erased
+	for (int x = 1; x < _width; x += 2) {
+		for (int y = 1; y < _height; y += 2) {
+			int symbol = grid[x][y];
+			if ((symbol & 0xF000000) || (symbol & 0xF00) != Decoration::Triangle) continue;
+			int index = static_cast<int>(_counters.size());
+			_counters.push_back({ 0, (symbol & 0xf0000) >> 16 });
+			_watchers[(x + 1) % _width][y].push_back(index);
+			_watchers[(x - 1 + _width) % _width][y].push_back(index);
+			_watchers[x][y - 1].push_back(index);
+			_watchers[x][y + 1].push_back(index);
+		}
+	}
+}
+
+//Points along an arrow's ray, following the same rules as SymbolChecker::checkArrow
+void PathChecker::add_ray(int x, int y, int symbol)
+{
+	const int DIRECTIONS[8][2] = { { 0, 2 }, { 0, -2 }, { 2, 0 }, { -2, 0 }, { 2, 2 }, { 2, -2 }, { -2, -2 }, { -2, 2 } };
+	int dir = (symbol & 0xf0000) >> 16;
+	if (dir >= 8) return;
+	int dx = DIRECTIONS[dir][0], dy = DIRECTIONS[dir][1];
+	int index = static_cast<int>(_counters.size());
+	_counters.push_back({ 0, (symbol & 0xf000) >> 12 });
+	x += dx / 2; y += dy / 2;
+	while (y >= 0 && y < _height) {
+		if (_pillarWidth) x = (x + _width) % _width;
+		else if (x < 0 || x >= _width) break;
+		if (_watchers[x][y].size() && _watchers[x][y].back() == index) break; //Wrapped all the way around the pillar
+		_watchers[x][y].push_back(index);
+		x += dx; y += dy;
+	}
+}
+
+void PathChecker::update(Point pos, int amount)
+{
+	for (int index : _watchers[pos.first][pos.second]) {
+		Counter& counter = _counters[index];
+		bool wasOver = counter.count > counter.target;
+		counter.count += amount;
+		bool isOver = counter.count > counter.target;
+		_violations += static_cast<int>(isOver) - static_cast<int>(wasOver);
+	}
+}
+
+void PathChecker::push(Point pos)
+{
+	bool added = _pathGrid[pos.first][pos.second] != PATH;
+	if (added) {
+		_pathGrid[pos.first][pos.second] = PATH;
+		update(pos, 1);
+	}
+	_points.push_back(pos);
+	_added.push_back(added);
+}
+
+void PathChecker::pop()
+{
+	Point pos = _points.back();
+	if (_added.back()) {
+		_pathGrid[pos.first][pos.second] = _grid[pos.first][pos.second];
+		update(pos, -1);
+	}
+	_points.pop_back();
+	_added.pop_back();
+}
+
+void PathChecker::set_path(const std::vector<Point>& points)
+{
+	size_t common = 0;
+	while (common < points.size() && common < _points.size() && points[common] == _points[common]) common++;
+	while (_points.size() > common) pop();
+	for (size_t i = common; i < points.size(); i++) push(points[i]);
+}
+
+void PathChecker::clear()
+{
+	while (_points.size()) pop();
+}
+
+bool PathChecker::check_sealed(const Bitboard& reachable) const
+{
+	if (!_hasRegionSymbols) return true;
+	RegionKernel kernel(_pathGrid, Point(1, 1), _pillarWidth > 0, false);
+	kernel.label_regions();
+	for (const Bitboard& region : kernel.get_regions()) {
+		std::set<Point> cells = kernel.to_points(region);
+		bool sealed = true;
+		for (Point p : cells) {
+			for (int dx = -1; dx <= 1 && sealed; dx++) {
+				for (int dy = -1; dy <= 1 && sealed; dy++) {
+					int x = p.first + dx, y = p.second + dy;
+					if (_pillarWidth) x = (x + _width) % _width;
+					if (x >= 0 && y >= 0 && x < _width && y < _height && reachable.get(x, y)) sealed = false;
+				}
+			}
+		}
+		if (!sealed) continue;
+		int ghosts = 0, dice = 0, symbols = 0, stoneColor = 0, area = 0, negativeArea = 0;
+		bool erasers = false, mixedStones = false;
+		std::vector<int> colorCount(16, 0);
+		for (Point p : cells) {
+			int symbol = _grid[p.first][p.second];
+			if (symbol) symbols++;
+			if ((symbol & 0xF000000) == Decoration::Ghost) ghosts++;
+			if ((symbol & 0xF000000) == Decoration::Dice) dice += (symbol & 0xF0000) >> 16;
+			if (symbol & 0xF000000) continue;
+			int type = symbol & 0xF00, color = symbol & 0xf;
+			if (type == Decoration::Eraser) erasers = true;
+			if (type == Decoration::Stone || type == Decoration::Star || type == Decoration::Poly || type == Decoration::Triangle || type == Decoration::Eraser) colorCount[color]++;
+			if (type == Decoration::Stone) {
+				if (stoneColor && stoneColor != color) mixedStones = true;
+				stoneColor = color;
+			}
+			if (type == Decoration::Poly) {
+				int blocks = 0;
+				for (int bits = (symbol >> 16) & 0xffff; bits; bits &= bits - 1) blocks++;
+				if (symbol & Decoration::Negative) negativeArea += blocks;
+				else area += blocks;
+			}
+		}
+		//Custom symbols that only depend on what is inside the region (see SymbolChecker)
+		if (_hasGhosts && ghosts != 1) return false;
+		for (Point p : cells) {
+			int symbol = _grid[p.first][p.second];
+			if ((symbol & 0xF000000) == Decoration::Dice && dice != static_cast<int>(cells.size())) return false;
+			if ((symbol & 0xF000000) == Decoration::Diamond && symbols != (symbol & 0xF0000) >> 16) return false;
+		}
+		if (erasers) continue;
+		if (mixedStones) return false;
+		if ((area || negativeArea) && area != negativeArea && area - negativeArea != static_cast<int>(cells.size())) return false;
+		for (Point p : cells) {
+			int symbol = _grid[p.first][p.second];
+			if (symbol & 0xF000000) continue;
+			if ((symbol & 0xF00) == Decoration::Star && colorCount[symbol & 0xf] != 2) return false;
+			if ((symbol & 0xF00) == Decoration::Triangle) {
+				int x = p.first, y = p.second;
+				int count = (_pathGrid[(x + 1) % _width][y] == PATH) + (_pathGrid[(x - 1 + _width) % _width][y] == PATH) + (_pathGrid[x][y - 1] == PATH) + (_pathGrid[x][y + 1] == PATH);
+				if (count != (symbol & 0xf0000) >> 16) return false;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "GridTypes.h"
+#include "Bitboard.h"
+#include <stddef.h>
+#include <vector>
+
+//Keeps track of which symbols a partial path has already broken, updated one point at a time as the path grows or shrinks.
+//Arrows and triangles are counted as the line crosses them, so going over the target is caught the moment it happens.
+//Regions the line can no longer get into are final, so their symbols can be judged before the path is done (see check_sealed).
+//Used by the solver to drop partial lines, and by the symbol watchdog to have a verdict ready by the time the line is finished.
+class PathChecker {
+public:
+	PathChecker(const std::vector<std::vector<int>>& grid, int pillarWidth);
+
+	void push(Point pos); //Add a point to the path (points already on the path are allowed, and change nothing)
+	void pop(); //Take away the last point added
+	void set_path(const std::vector<Point>& points); //Pop back to where the current path and the new one diverge, then push the rest
+	void clear();
+	bool violated() const { return _violations > 0; } //Some symbol is broken no matter how the path continues
+	//Whether the symbols in regions that don't touch any point in reachable (the points the line can still get to) are satisfied
+	bool check_sealed(const Bitboard& reachable) const;
+
+	const std::vector<Point>& get_points() const { return _points; }
+	const std::vector<std::vector<int>>& get_grid() const { return _pathGrid; } //Grid with the path marked as PATH
+
+private:
+	struct Counter {
+		int count, target;
+	};
+
+	void add_ray(int x, int y, int symbol);
+	void update(Point pos, int amount);
+
+	std::vector<std::vector<int>> _grid, _pathGrid;
+	int _width, _height, _pillarWidth;
+	bool _hasErasers, _hasGhosts, _hasRegionSymbols; //Region symbols are the ones check_sealed looks at
+	std::vector<Counter> _counters; //One for each arrow and triangle
+	std::vector<std::vector<std::vector<int>>> _watchers; //Counters affected by each grid point
+	std::vector<Point> _points;
+	std::vector<bool> _added; //Whether each point on the stack was new to the path
+	int _violations; //Counters that are over their target
+};
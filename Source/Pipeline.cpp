@@ -0,0 +1,146 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "Pipeline.h"
+#include <chrono>
+#include <sstream>
+
+Pipeline::Pipeline(int depth)
+{
+	_memory = std::make_shared<Memory>("witness64_d3d11.exe");
+	_depth = depth > 0 ? depth : 1;
+	_inFlight = 0;
+	_stats[Encode] = { L"encode", 0, 0, 0, 0 };
+	_stats[Write] = { L"write", 0, 0, 0, 0 };
+	_stop = false;
+	Memory::panelFence = [this](int panel) { wait_panel(panel, Encode); };
+	_threads[Encode] = std::thread(&Pipeline::run, this, Encode);
+	_threads[Write] = std::thread(&Pipeline::run, this, Write);
+}
+
+Pipeline::~Pipeline()
+{
+	Memory::panelFence = nullptr;
+	std::unique_lock<std::mutex> lock(_mutex);
+	_stop = true;
+	lock.unlock();
+	_changed.notify_all();
+	for (std::thread& thread : _threads) thread.join();
+}
+
+void Pipeline::add(const PanelImage& image)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_changed.wait(lock, [&] { return _inFlight < _depth; });
+	_inFlight++;
+	_queues[Encode].push_back(std::make_shared<Item>(Item{ image, WriteQueue() }));
+	int depth = static_cast<int>(_queues[Encode].size());
+	if (depth > _stats[Encode].maxDepth) _stats[Encode].maxDepth = depth;
+	lock.unlock();
+	_changed.notify_all();
+}
+
+void Pipeline::finish()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_changed.wait(lock, [&] { return _inFlight == 0; });
+	std::exception_ptr error = _error;
+	_error = nullptr;
+	lock.unlock();
+	for (const StageStats& stats : getStats()) {
+		std::wstringstream text;
+		text << L"Pipeline " << stats.name << L": " << stats.items << L" puzzles, max queue " << stats.maxDepth << L", " <<
+			(stats.items ? stats.totalTime / stats.items : 0) << L" ms average, " << stats.maxTime << L" ms max\n";
+		OutputDebugStringW(text.str().c_str());
+	}
+	if (error) std::rethrow_exception(error);
+}
+
+std::vector<Pipeline::StageStats> Pipeline::getStats()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return { _stats[Encode], _stats[Write] };
+}
+
+void Pipeline::run(Stage stage)
+{
+	if (stage == Encode) Memory::panelFence = [this](int panel) { wait_panel(panel, Write); };
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true) {
+		_changed.wait(lock, [&] { return _stop || !_queues[stage].empty(); });
+		if (_queues[stage].empty()) return; //Stopped, and nothing is left
+		std::shared_ptr<Item> item = _queues[stage].front();
+		_queues[stage].pop_front();
+		_current[stage] = item;
+		bool skip = _error != nullptr;
+		lock.unlock();
+
+		std::exception_ptr error;
+		auto start = std::chrono::steady_clock::now();
+		if (!skip) {
+			try {
+				handle(stage, *item);
+			}
+			catch (...) {
+				error = std::current_exception();
+			}
+		}
+		double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		lock.lock();
+		_current[stage] = nullptr;
+		if (error && !_error) _error = error;
+		if (!skip) {
+			_stats[stage].items++;
+			_stats[stage].totalTime += time;
+			if (time > _stats[stage].maxTime) _stats[stage].maxTime = time;
+		}
+		if (stage == Encode) {
+			_queues[Write].push_back(item);
+			int depth = static_cast<int>(_queues[Write].size());
+			if (depth > _stats[Write].maxDepth) _stats[Write].maxDepth = depth;
+		}
+		else _inFlight--;
+		_changed.notify_all();
+	}
+}
+
+void Pipeline::handle(Stage stage, Item& item)
+{
+	if (stage == Encode) {
+		Memory::writeQueue = &item.writes;
+		try {
+			Generate::commit(item.image);
+		}
+		catch (...) {
+			Memory::writeQueue = nullptr;
+			throw;
+		}
+		Memory::writeQueue = nullptr;
+	}
+	else {
+		_memory->Flush(item.writes);
+		item.writes = WriteQueue();
+	}
+}
+
+void Pipeline::wait_panel(int panel, Stage from)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_changed.wait(lock, [&] {
+		for (int stage = from; stage <= Write; stage++) {
+			if (has_panel(static_cast<Stage>(stage), panel)) return false;
+		}
+		return true;
+	});
+}
+
+bool Pipeline::has_panel(Stage stage, int panel) const
+{
+	if (_current[stage] && _current[stage]->image.id == panel) return true;
+	for (const std::shared_ptr<Item>& item : _queues[stage]) {
+		if (item->image.id == panel) return true;
+	}
+	return false;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Generate.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+//Writes puzzles to the game on threads of its own, so the generator can go on to the next puzzle while the last one is still being written (see Generate::setPipeline).
+//Each puzzle goes through two stages, one thread each, in the order the puzzles were added:
+//Encode - builds the panel's geometry and colors (Generate::commit), holding its game writes back in a WriteQueue
+//Write - makes those writes
+//The thread that made the pipeline waits before touching a panel that is still in it, and the encode stage waits for panels that haven't been written yet.
+class Pipeline {
+public:
+	Pipeline(int depth); //depth - the most puzzles that can be in the pipeline at once. Make (and destroy) the pipeline on the thread that generates the puzzles.
+	~Pipeline();
+
+	void add(const PanelImage& image); //Waits if the pipeline is full
+	void finish(); //Wait until every puzzle has been written, and log the stage stats. Throws if a puzzle couldn't be written.
+
+	struct StageStats {
+		const wchar_t* name;
+		int items;
+		int maxDepth; //The most puzzles that were waiting for the stage at once
+		double totalTime, maxTime; //Milliseconds spent on the puzzles
+	};
+	std::vector<StageStats> getStats();
+
+private:
+	enum Stage { Encode, Write };
+
+	struct Item {
+		PanelImage image;
+		WriteQueue writes;
+	};
+
+	void run(Stage stage);
+	void handle(Stage stage, Item& item);
+	void wait_panel(int panel, Stage from); //Wait until no puzzle for the panel is in this stage or the ones after it
+	bool has_panel(Stage stage, int panel) const;
+
+	std::shared_ptr<Memory> _memory; //For the write stage
+	int _depth, _inFlight;
+	std::deque<std::shared_ptr<Item>> _queues[2];
+	std::shared_ptr<Item> _current[2]; //The puzzle each stage is working on
+	StageStats _stats[2];
+	std::exception_ptr _error; //The first puzzle that failed. Puzzles after it are dropped.
+	bool _stop;
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::thread _threads[2];
+};
@@ -0,0 +1,227 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "PivotGenerate.h"
+#include "Random.h"
+#include <algorithm>
+
+PivotGenerate::PivotGenerate(int width, int height)
+{
+	_width = width;
+	_height = height;
+	_start = Point(width / 2, height - 1);
+	_exits = { Point(0, height / 2), Point(width - 1, height / 2), Point(width / 2, 0) };
+}
+
+bool PivotGenerate::generate(const std::vector<std::pair<int, int>>& symbolVec)
+{
+	if (_width > Bitboard::SIZE || _height > Bitboard::SIZE) return false; //The paths are stored as bitboards of grid points
+	_grid.assign(_width, std::vector<int>(_height, 0));
+	if (!generate_paths()) return false;
+	_regions.clear();
+	for (const Bitboard& path : _paths) {
+		std::vector<std::vector<int>> grid(_width, std::vector<int>(_height, 0));
+		for (int x = 0; x < _width; x++) {
+			for (int y = 0; y < _height; y++) {
+				if (path.get(x, y)) grid[x][y] = PATH;
+			}
+		}
+		std::shared_ptr<RegionKernel> regions = std::make_shared<RegionKernel>(grid, Point(1, 1), false, false);
+		regions->label_regions();
+		_regions.push_back(regions);
+	}
+	_open.clear();
+	for (int x = 1; x < _width; x += 2) {
+		for (int y = 1; y < _height; y += 2) _open.insert(Point(x, y));
+	}
+	//Stars go last, so that an odd one out can pair up with a stone or triangle
+	for (int type : { Decoration::Stone, Decoration::Triangle, Decoration::Star }) {
+		for (std::pair<int, int> s : symbolVec) {
+			if ((s.first & 0x700) != type) continue;
+			if (type == Decoration::Stone && !place_stones(s.first & 0xf, s.second)) return false;
+			if (type == Decoration::Triangle && !place_triangles(s.first & 0xf, s.second)) return false;
+			if (type == Decoration::Star && !place_stars(s.first & 0xf, s.second)) return false;
+		}
+	}
+	return true;
+}
+
+//The first path goes to the first exit. The others each keep the start of a random earlier path and branch off from there to their own exit.
+bool PivotGenerate::generate_paths()
+{
+	int minLength = (_width / 2 + 1) * (_height / 2 + 1) / 2;
+	std::vector<std::vector<Point>> lines;
+	for (Point exit : _exits) {
+		std::vector<Point> path = { _start };
+		if (lines.size()) {
+			const std::vector<Point>& base = lines[Random::rand() % lines.size()];
+			path.assign(base.begin(), base.begin() + 1 + Random::rand() % (base.size() - 1));
+		}
+		if (!grow_path(path, exit, minLength)) return false;
+		lines.push_back(path);
+	}
+	_paths.clear();
+	for (const std::vector<Point>& line : lines) {
+		Bitboard path;
+		for (size_t i = 0; i < line.size(); i++) {
+			path.set(line[i].first, line[i].second);
+			if (i > 0) path.set((line[i].first + line[i - 1].first) / 2, (line[i].second + line[i - 1].second) / 2);
+		}
+		_paths.push_back(path);
+	}
+	return true;
+}
+
+bool PivotGenerate::grow_path(std::vector<Point>& path, Point exit, int minLength)
+{
+	Bitboard visited;
+	for (Point p : path) visited.set(p.first, p.second);
+	int budget = _SEARCH_BUDGET;
+	return search(path, visited, exit, minLength, budget);
+}
+
+//Random depth first search for the exit, going between intersections
+bool PivotGenerate::search(std::vector<Point>& path, Bitboard& visited, Point exit, int minLength, int& budget)
+{
+	Point pos = path.back();
+	if (pos == exit) return static_cast<int>(path.size()) >= minLength;
+	if (--budget <= 0) return false;
+	const int DIRECTIONS[4][2] = { { 0, 2 }, { 0, -2 }, { 2, 0 }, { -2, 0 } };
+	int first = Random::rand() % 4;
+	for (int i = 0; i < 4; i++) {
+		int dir = (first + i) % 4;
+		int x = pos.first + DIRECTIONS[dir][0], y = pos.second + DIRECTIONS[dir][1];
+		if (x < 0 || y < 0 || x >= _width || y >= _height || visited.get(x, y)) continue;
+		visited.set(x, y);
+		path.push_back(Point(x, y));
+		if (search(path, visited, exit, minLength, budget)) return true;
+		path.pop_back();
+		visited.reset(x, y);
+		if (budget <= 0) return false;
+	}
+	return false;
+}
+
+int PivotGenerate::count_sides(size_t path, Point cell) const
+{
+	const Bitboard& points = _paths[path];
+	return points.get(cell.first - 1, cell.second) + points.get(cell.first + 1, cell.second) + points.get(cell.first, cell.second - 1) + points.get(cell.first, cell.second + 1);
+}
+
+bool PivotGenerate::place_triangles(int color, int amount)
+{
+	std::vector<Point> open;
+	for (Point cell : _open) {
+		int count = count_sides(0, cell);
+		if (count && count_sides(1, cell) == count && count_sides(2, cell) == count) open.push_back(cell);
+	}
+	while (amount > 0) {
+		if (open.empty()) return false;
+		Point cell = pop_random(open);
+		int symbol = Decoration::Triangle | (count_sides(0, cell) << 16) | color;
+		if (!can_place(cell, symbol)) continue;
+		set(cell, symbol);
+		amount--;
+	}
+	return true;
+}
+
+bool PivotGenerate::place_stones(int color, int amount)
+{
+	std::vector<Point> open(_open.begin(), _open.end());
+	while (amount > 0) {
+		if (open.empty()) return false;
+		Point cell = pop_random(open);
+		if (!can_place(cell, Decoration::Stone | color)) continue;
+		set(cell, Decoration::Stone | color);
+		amount--;
+	}
+	return true;
+}
+
+//Stars go in pairs that every path puts in the same region. With an odd number, the last one pairs up with a symbol of the same color that is already there.
+bool PivotGenerate::place_stars(int color, int amount)
+{
+	int symbol = Decoration::Star | color;
+	std::vector<Point> open(_open.begin(), _open.end());
+	while (amount > 0) {
+		if (open.empty()) return false;
+		Point cell = pop_random(open);
+		if (!can_place(cell, symbol)) continue;
+		if (amount == 1) {
+			bool paired = true;
+			for (size_t i = 0; i < _regions.size(); i++) {
+				if (count_color(i, cell, color) != 1) paired = false;
+			}
+			if (!paired) continue;
+			set(cell, symbol);
+			break;
+		}
+		set(cell, symbol);
+		std::vector<Point> partners;
+		for (Point p : _open) {
+			bool together = can_place(p, symbol);
+			for (size_t i = 0; i < _regions.size() && together; i++) {
+				if (_regions[i]->get_label(p) != _regions[i]->get_label(cell)) together = false;
+			}
+			if (together) partners.push_back(p);
+		}
+		if (partners.empty()) {
+			set(cell, 0);
+			continue;
+		}
+		Point partner = pop_random(partners);
+		set(partner, symbol);
+		open.erase(std::remove(open.begin(), open.end(), partner), open.end());
+		amount -= 2;
+	}
+	return true;
+}
+
+//Number of symbols of the given color in the region around cell, for one of the paths
+int PivotGenerate::count_color(size_t path, Point cell, int color) const
+{
+	const RegionKernel& regions = *_regions[path];
+	int count = 0;
+	for (Point p : regions.to_points(regions.get_regions()[regions.get_label(cell)])) {
+		if (_grid[p.first][p.second] && (_grid[p.first][p.second] & 0xf) == color) count++;
+	}
+	return count;
+}
+
+//Whether a symbol can go on the cell without breaking any path: stones can't share a region with other colors,
+//and a region with a star can't end up with more than two symbols of its color
+bool PivotGenerate::can_place(Point cell, int symbol) const
+{
+	int type = symbol & 0x700, color = symbol & 0xf;
+	for (const std::shared_ptr<RegionKernel>& regions : _regions) {
+		int count = 1;
+		bool star = (type == Decoration::Star);
+		for (Point p : regions->to_points(regions->get_regions()[regions->get_label(cell)])) {
+			int other = _grid[p.first][p.second];
+			if (!other) continue;
+			if (type == Decoration::Stone && (other & 0x700) == Decoration::Stone && (other & 0xf) != color) return false;
+			if ((other & 0xf) != color) continue;
+			count++;
+			if ((other & 0x700) == Decoration::Star) star = true;
+		}
+		if (star && count > 2) return false;
+	}
+	return true;
+}
+
+void PivotGenerate::set(Point cell, int symbol)
+{
+	_grid[cell.first][cell.second] = symbol;
+	if (symbol) _open.erase(cell);
+	else _open.insert(cell);
+}
+
+Point PivotGenerate::pop_random(std::vector<Point>& points)
+{
+	size_t index = Random::rand() % points.size();
+	Point point = points[index];
+	points.erase(points.begin() + index);
+	return point;
+}
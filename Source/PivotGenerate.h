@@ -0,0 +1,48 @@
+#pragma once
+#include "GridTypes.h"
+#include "Bitboard.h"
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+//Generates pivot panels: one set of symbols that works for a line from the start (bottom middle) to each of the three exits (left, right and top).
+//The three paths are grown together, each one branching off an earlier one, so they share a trunk and agree about most of the panel.
+//Symbols are then only placed where they agree with all three paths: triangles where every path has the same number of sides,
+//stones where no path puts them with another color, and stars in pairs that every path keeps together. Other symbols aren't supported.
+//Doesn't touch the game's memory. See Special::generatePivotPanel for writing the result.
+class PivotGenerate {
+public:
+	//width, height - size of the grid (2 * blocks + 1)
+	PivotGenerate(int width, int height);
+
+	//Grow the paths and place the symbols (pairs of symbol and amount). Returns false if the paths didn't leave room for all of them, in which case just try again.
+	bool generate(const std::vector<std::pair<int, int>>& symbolVec);
+
+	const std::vector<std::vector<int>>& get_grid() const { return _grid; } //The symbols placed, in the same layout as Panel::_grid
+	Point get_start() const { return _start; }
+	const std::vector<Point>& get_exits() const { return _exits; }
+
+private:
+	bool generate_paths();
+	bool grow_path(std::vector<Point>& path, Point exit, int minLength);
+	bool search(std::vector<Point>& path, Bitboard& visited, Point exit, int minLength, int& budget);
+	int count_sides(size_t path, Point cell) const;
+	bool place_triangles(int color, int amount);
+	bool place_stones(int color, int amount);
+	bool place_stars(int color, int amount);
+	int count_color(size_t path, Point cell, int color) const;
+	bool can_place(Point cell, int symbol) const;
+	void set(Point cell, int symbol);
+	Point pop_random(std::vector<Point>& points);
+
+	int _width, _height;
+	Point _start;
+	std::vector<Point> _exits;
+	std::vector<std::vector<int>> _grid;
+	std::vector<Bitboard> _paths; //Points covered by each path, including the edges between intersections
+	std::vector<std::shared_ptr<RegionKernel>> _regions; //Regions made by each path
+	std::set<Point> _open; //Grid blocks with nothing on them yet
+
+	static const int _SEARCH_BUDGET = 2000; //Steps a path gets to find its exit before the whole attempt is thrown out
+};
@@ -0,0 +1,280 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "PlacementSolver.h"
+#include "Random.h"
+#include <algorithm>
+#include <numeric>
+
+PlacementSolver::PlacementSolver(const std::vector<PlacementRegion>& regions)
+{
+	_regions = regions;
+	stoneSpread = 1;
+}
+
+void PlacementSolver::add(int symbol, int amount)
+{
+	if (amount <= 0) return;
+	Group group = { (symbol & 0xF000000) ? symbol & 0xF000000 : symbol & 0x700, symbol & 0xf, (symbol >> 16) & 0xf, amount };
+	for (Group& other : _groups) {
+		if (other.type == group.type && other.color == group.color && other.number == group.number) {
+			other.amount += amount;
+			return;
+		}
+	}
+	_groups.push_back(group);
+}
+
+bool PlacementSolver::solve(int budget)
+{
+	const int ORDER[] = { Decoration::Stone, Decoration::Triangle, Decoration::Dice, Decoration::Diamond, Decoration::Star };
+	std::stable_sort(_groups.begin(), _groups.end(), [&](const Group& a, const Group& b) {
+		return std::find(ORDER, ORDER + 5, a.type) < std::find(ORDER, ORDER + 5, b.type); });
+	_counts.assign(_regions.size(), std::vector<int>(_groups.size(), 0));
+	_placements.clear();
+	return search(0, _groups.size() ? _groups[0].amount : 0, budget);
+}
+
+//Put the remaining (left) symbols of a group into regions, then move on to the next group
+bool PlacementSolver::search(size_t group, int left, int& budget)
+{
+	if (group == _groups.size()) {
+		for (size_t r = 0; r < _regions.size(); r++) {
+			if (!is_complete(r)) return false;
+		}
+		return assign_cells();
+	}
+	if (left == 0) {
+		if (!is_spread(group)) return false;
+		return search(group + 1, group + 1 < _groups.size() ? _groups[group + 1].amount : 0, budget);
+	}
+	if (budget-- <= 0) return false;
+	std::vector<size_t> order(_regions.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::shuffle(order.begin(), order.end(), Random::gen);
+	if (_groups[group].type == Decoration::Stone) { //Try regions without this color first, so the stones get spread out
+		std::stable_partition(order.begin(), order.end(), [&](size_t r) { return _counts[r][group] == 0; });
+	}
+	for (size_t r : order) {
+		int step = get_step(r, group, left);
+		if (step == 0 || step > left) continue;
+		_counts[r][group] += step;
+		if (is_consistent(r) && search(group, left - step, budget)) return true;
+		_counts[r][group] -= step;
+	}
+	return false;
+}
+
+//How many symbols of the group to add to the region at once, or 0 if they can't go there
+int PlacementSolver::get_step(size_t region, size_t group, int left) const
+{
+	const PlacementRegion& reg = _regions[region];
+	const Group& g = _groups[group];
+	if (reg.open.empty()) return 0;
+	if (g.type == Decoration::Star) { //Stars come in pairs, or join a single symbol of their color
+		int count = count_color(region, g.color);
+		if (count == 0) return left >= 2 ? 2 : 0;
+		return count == 1 ? 1 : 0;
+	}
+	if (g.type == Decoration::Dice) {
+		if (g.number) { //All the dice the region needs go in at once
+			if (_counts[region][group] || reg.size % g.number) return 0;
+			return reg.size / g.number;
+		}
+		if (_counts[region][group]) return 1;
+		int need = reg.size;
+		for (size_t i = 0; i < _groups.size(); i++) {
+			if (_groups[i].type == Decoration::Dice) need -= _counts[region][i] * (_groups[i].number ? _groups[i].number : 1);
+		}
+		return need > 6 ? (need + 5) / 6 : 1; //Enough dice to add up to the size of the region
+	}
+	return 1;
+}
+
+//Whether the region can still be finished. These rules can only get worse as more symbols are added.
+bool PlacementSolver::is_consistent(size_t region) const
+{
+	const PlacementRegion& reg = _regions[region];
+	int placed = 0;
+	for (int count : _counts[region]) placed += count;
+	if (placed > static_cast<int>(reg.open.size())) return false;
+	int customCells = 0, triangleCells = 0;
+	for (const PlacementCell& cell : reg.open) {
+		if (cell.allowCustom) customCells++;
+		if (cell.allowTriangle && cell.sides > 0) triangleCells++;
+	}
+	if (count_type(region, Decoration::Dice) + count_type(region, Decoration::Diamond) > customCells) return false;
+	if (count_type(region, Decoration::Triangle) > triangleCells) return false;
+	int stoneColor = -1;
+	for (int symbol : reg.symbols) {
+		if (!(symbol & 0xF000000) && (symbol & 0x700) == Decoration::Stone) stoneColor = symbol & 0xf;
+	}
+	int diceSum = 0;
+	for (size_t i = 0; i < _groups.size(); i++) {
+		const Group& g = _groups[i];
+		int count = _counts[region][i];
+		if (count == 0) continue;
+		if (g.type == Decoration::Stone) {
+			if (stoneColor != -1 && stoneColor != g.color) return false;
+			stoneColor = g.color;
+		}
+		if (g.type == Decoration::Star && count_color(region, g.color) > 2) return false;
+		if (g.type == Decoration::Diamond && count_symbols(region) > (g.number ? g.number : 5)) return false;
+		if (g.type == Decoration::Dice) diceSum += count * (g.number ? g.number : 1);
+		if (g.type == Decoration::Triangle && g.number) {
+			int same = 0, cells = 0;
+			for (size_t j = 0; j < _groups.size(); j++) {
+				if (_groups[j].type == Decoration::Triangle && _groups[j].number == g.number) same += _counts[region][j];
+			}
+			for (const PlacementCell& cell : reg.open) {
+				if (cell.allowTriangle && cell.sides == g.number) cells++;
+			}
+			if (same > cells) return false;
+		}
+	}
+	return diceSum <= reg.size;
+}
+
+//The rules that can only be checked once everything is in
+bool PlacementSolver::is_complete(size_t region) const
+{
+	int diceSum = 0, freeDice = 0;
+	for (size_t i = 0; i < _groups.size(); i++) {
+		const Group& g = _groups[i];
+		int count = _counts[region][i];
+		if (count == 0) continue;
+		if (g.type == Decoration::Star && count_color(region, g.color) != 2) return false;
+		if (g.type == Decoration::Diamond && g.number && count_symbols(region) != g.number) return false;
+		if (g.type == Decoration::Dice) {
+			if (g.number) diceSum += count * g.number;
+			else freeDice += count;
+		}
+	}
+	if (diceSum + freeDice == 0) return true;
+	return diceSum + freeDice <= _regions[region].size && diceSum + freeDice * 6 >= _regions[region].size;
+}
+
+bool PlacementSolver::is_spread(size_t group) const
+{
+	const Group& g = _groups[group];
+	if (g.type != Decoration::Stone) return true;
+	int regions = 0;
+	for (size_t r = 0; r < _regions.size(); r++) {
+		if (_counts[r][group]) regions++;
+	}
+	return regions >= (g.amount < stoneSpread ? g.amount : stoneSpread);
+}
+
+//Symbols in the region with the given color, the way stars count them
+int PlacementSolver::count_color(size_t region, int color) const
+{
+	int count = 0;
+	for (int symbol : _regions[region].symbols) {
+		if ((symbol & 0xf) == color) count++;
+	}
+	for (size_t i = 0; i < _groups.size(); i++) {
+		if (_groups[i].color == color) count += _counts[region][i];
+	}
+	return count;
+}
+
+int PlacementSolver::count_symbols(size_t region) const
+{
+	int count = static_cast<int>(_regions[region].symbols.size());
+	for (int c : _counts[region]) count += c;
+	return count;
+}
+
+int PlacementSolver::count_type(size_t region, int type) const
+{
+	int count = 0;
+	for (size_t i = 0; i < _groups.size(); i++) {
+		if (_groups[i].type == type) count += _counts[region][i];
+	}
+	return count;
+}
+
+//Pick a block for every symbol, now that each one has a region
+bool PlacementSolver::assign_cells()
+{
+	_placements.clear();
+	for (size_t r = 0; r < _regions.size(); r++) {
+		std::vector<size_t> items; //One group index per symbol, the pickiest ones first
+		for (int pass = 0; pass < 4; pass++) {
+			for (size_t i = 0; i < _groups.size(); i++) {
+				const Group& g = _groups[i];
+				int rank = g.type == Decoration::Triangle ? (g.number ? 0 : 1) : g.type == Decoration::Dice || g.type == Decoration::Diamond ? 2 : 3;
+				if (rank == pass) items.insert(items.end(), _counts[r][i], i);
+			}
+		}
+		if (items.empty()) continue;
+		std::vector<Point> cells(items.size());
+		std::vector<bool> used(_regions[r].open.size(), false);
+		int budget = _CELL_BUDGET;
+		if (!assign_region(r, items, 0, cells, used, budget)) return false;
+		//Dice without a set number split what is left of the region's size between them, 1 to 6 each
+		std::vector<int> rolls;
+		int left = _regions[r].size;
+		for (size_t item : items) {
+			if (_groups[item].type != Decoration::Dice) continue;
+			if (_groups[item].number) left -= _groups[item].number;
+			else rolls.push_back(1);
+		}
+		left -= static_cast<int>(rolls.size());
+		while (left > 0 && rolls.size()) {
+			int i = Random::rand() % rolls.size();
+			if (rolls[i] == 6) continue;
+			rolls[i]++;
+			left--;
+		}
+		for (size_t i = 0; i < items.size(); i++) {
+			_placements.push_back({ cells[i], make_symbol(r, _groups[items[i]], cells[i], rolls) });
+		}
+	}
+	return true;
+}
+
+bool PlacementSolver::assign_region(size_t region, const std::vector<size_t>& items, size_t index, std::vector<Point>& cells, std::vector<bool>& used, int& budget)
+{
+	if (index == items.size()) return true;
+	if (budget-- <= 0) return false;
+	const std::vector<PlacementCell>& open = _regions[region].open;
+	std::vector<size_t> order(open.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::shuffle(order.begin(), order.end(), Random::gen);
+	for (size_t i : order) {
+		if (used[i] || !fits(open[i], _groups[items[index]])) continue;
+		used[i] = true;
+		cells[index] = open[i].pos;
+		if (assign_region(region, items, index + 1, cells, used, budget)) return true;
+		used[i] = false;
+	}
+	return false;
+}
+
+bool PlacementSolver::fits(const PlacementCell& cell, const Group& group) const
+{
+	if (group.type == Decoration::Triangle) return cell.allowTriangle && cell.sides > 0 && (!group.number || cell.sides == group.number);
+	if (group.type == Decoration::Dice || group.type == Decoration::Diamond) return cell.allowCustom;
+	return true;
+}
+
+int PlacementSolver::make_symbol(size_t region, const Group& group, Point pos, std::vector<int>& rolls) const
+{
+	if (group.type == Decoration::Triangle) {
+		for (const PlacementCell& cell : _regions[region].open) {
+			if (cell.pos == pos) return Decoration::Triangle | group.color | (cell.sides << 16);
+		}
+	}
+	if (group.type == Decoration::Diamond) return Decoration::Diamond | group.color | ((group.number ? group.number : count_symbols(region)) << 16);
+	if (group.type == Decoration::Dice) {
+		int roll = group.number;
+		if (!roll) {
+			roll = rolls.back();
+			rolls.pop_back();
+		}
+		return Decoration::Dice | group.color | (roll << 16);
+	}
+	return group.type | group.color;
+}
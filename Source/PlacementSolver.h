@@ -0,0 +1,65 @@
+#pragma once
+#include "GridTypes.h"
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+//A grid block that symbols can still go on
+struct PlacementCell {
+	Point pos;
+	int sides; //How many of its edges the path covers (for triangles)
+	bool allowTriangle;
+	bool allowCustom; //Custom symbols don't draw right in the center column (see Generate::in_center)
+};
+
+//One region made by the finished path
+struct PlacementRegion {
+	int size; //Number of grid blocks
+	std::vector<int> symbols; //Symbols that are already there
+	std::vector<PlacementCell> open;
+};
+
+//Places stones, triangles, dice, diamonds and stars around a path that is already fixed, by solving it as a constraint problem.
+//With the path fixed the regions are too, and each of these symbols only depends on what ends up in its own region (and a triangle on its own block).
+//So the search decides how many of each symbol go in each region, trying regions in random order and backing up as soon as a region breaks a rule
+//that can only get worse (two stone colors, a third symbol of a star's color, more symbols than a diamond shows, more dice than blocks).
+//Once every symbol has a region, the rest of the rules are checked and blocks are picked for each symbol.
+//Used by Generate for panels where placing the symbols one at a time keeps failing. Doesn't touch the game's memory.
+class PlacementSolver {
+public:
+	PlacementSolver(const std::vector<PlacementRegion>& regions);
+
+	//symbol - as in PuzzleSymbols, including the color and the number for triangles, dice and diamonds (0 for any)
+	void add(int symbol, int amount);
+	//Search for a placement, giving up after budget choices. Returns false if none was found, in which case the path should be thrown out.
+	bool solve(int budget);
+
+	const std::vector<std::pair<Point, int>>& get_placements() const { return _placements; } //Each block and the symbol to put on it
+
+	int stoneSpread; //Stones of each color have to be spread over at least this many regions (or one region per stone, if there are fewer)
+
+private:
+	struct Group {
+		int type, color, number, amount; //number - for triangles, dice and diamonds, 0 for any
+	};
+
+	bool search(size_t group, int left, int& budget);
+	int get_step(size_t region, size_t group, int left) const;
+	bool is_consistent(size_t region) const;
+	bool is_complete(size_t region) const;
+	bool is_spread(size_t group) const;
+	int count_color(size_t region, int color) const;
+	int count_symbols(size_t region) const;
+	int count_type(size_t region, int type) const;
+	bool assign_cells();
+	bool assign_region(size_t region, const std::vector<size_t>& items, size_t index, std::vector<Point>& cells, std::vector<bool>& used, int& budget);
+	bool fits(const PlacementCell& cell, const Group& group) const;
+	int make_symbol(size_t region, const Group& group, Point pos, std::vector<int>& rolls) const;
+
+	std::vector<PlacementRegion> _regions;
+	std::vector<Group> _groups; //In the order they are placed: stones, triangles, dice, diamonds, stars
+	std::vector<std::vector<int>> _counts; //How many of each group are in each region
+	std::vector<std::pair<Point, int>> _placements;
+
+	static const int _CELL_BUDGET = 1000; //Tries a region gets to fit its symbols onto blocks
+};
@@ -0,0 +1,95 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "Progress.h"
+#include <sstream>
+
+Progress::Progress()
+{
+	_state = Idle;
+	_panel = _areaDone = _areaTotal = _done = _total = _attempts = _areaCount = 0;
+	_area = -1;
+	_cancelled = false;
+	_start = std::chrono::steady_clock::now();
+}
+
+Progress::~Progress()
+{
+	cancel();
+	if (_thread.joinable()) _thread.join();
+}
+
+void Progress::run(std::function<void()> work)
+{
+	if (_thread.joinable()) _thread.join();
+	_panel = _areaDone = _areaTotal = _done = _total = _attempts = _areaCount = 0;
+	_area = -1;
+	_cancelled = false;
+	_error.clear();
+	_start = std::chrono::steady_clock::now();
+	_state = Running;
+	_thread = std::thread([this, work]() {
+		try {
+			work();
+			_state = _cancelled ? Cancelled : Finished;
+		}
+		catch (const CancelledError&) {
+			_state = Cancelled;
+		}
+		catch (const std::exception& e) {
+			std::string message = e.what();
+			_error = std::wstring(message.begin(), message.end());
+			_state = Failed;
+		}
+		catch (...) {
+			_state = Failed;
+		}
+	});
+}
+
+void Progress::join()
+{
+	if (_thread.joinable()) _thread.join();
+}
+
+Progress::Snapshot Progress::read() const
+{
+	Snapshot snapshot;
+	snapshot.state = static_cast<State>(_state.load());
+	snapshot.panel = _panel;
+	int area = _area;
+	if (area >= 0) snapshot.area = _areaNames[area];
+	snapshot.areaDone = _areaDone;
+	snapshot.areaTotal = _areaTotal;
+	snapshot.done = _done;
+	snapshot.total = _total;
+	snapshot.attempts = _attempts;
+	snapshot.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+	if (snapshot.state == Failed) snapshot.error = _error;
+	return snapshot;
+}
+
+void Progress::setArea(const std::wstring& name, int puzzles)
+{
+	int slot = _areaCount++ % _AREA_SLOTS;
+	size_t length = name.size() < _AREA_LENGTH - 1 ? name.size() : _AREA_LENGTH - 1;
+	name.copy(_areaNames[slot], length);
+	_areaNames[slot][length] = 0;
+	_areaDone = 0;
+	_areaTotal = puzzles;
+	_area = slot;
+}
+
+//The text shown while randomizing, e.g. "Symmetry Island: 3/12 (10%)", with the attempt number in brackets once a puzzle has failed
+std::wstring Progress::Snapshot::describe() const
+{
+	if (state == Cancelled) return L"Cancelled.";
+	if (state == Failed) return L"Failed: " + error;
+	std::wstringstream text;
+	text << area;
+	if (areaTotal > 0) text << L": " << areaDone << L"/" << areaTotal;
+	if (total > 0) text << L" (" << done * 100 / total << L"%)";
+	if (attempts > 0) text << L" [" << attempts + 1 << L"]";
+	return text.str();
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+
+//How far along a randomization is. The thread generating puzzles writes to it and anything else can read it at any time (e.g. the UI, on a timer).
+//Everything is kept in atomics, so neither side ever waits on the other. It also holds the flag for cancelling the randomization.
+//Doesn't use anything from Windows, so it builds anywhere the generator does.
+class Progress {
+public:
+	enum State { Idle, Running, Finished, Cancelled, Failed };
+
+	struct Snapshot {
+		State state;
+		int panel; //The puzzle being generated (0 if none yet)
+		std::wstring area;
+		int areaDone, areaTotal;
+		int done, total;
+		int attempts; //Failed attempts at the current puzzle
+		double elapsed; //Seconds since the randomization started
+		std::wstring error; //If it failed
+		std::wstring describe() const;
+	};
+
+	//Thrown by the generator when it notices the randomization has been cancelled
+	class CancelledError : public std::exception {
+	public:
+		const char* what() const noexcept override { return "Randomization cancelled"; }
+	};
+
+	Progress();
+	~Progress(); //Cancels and waits for the thread, if there is one
+
+	//Run work on a thread of its own and return right away. The state shows whether it finished, failed or was cancelled.
+	void run(std::function<void()> work);
+	void join(); //Wait for the thread started by run. Call once the state is no longer Running.
+	Snapshot read() const;
+
+	void cancel() { _cancelled = true; }
+	bool isCancelled() const { return _cancelled; }
+	void checkCancelled() const { if (_cancelled) throw CancelledError(); }
+
+	//For the generator
+	void setTotal(int puzzles) { _total = puzzles; _done = 0; }
+	void setArea(const std::wstring& name, int puzzles);
+	void setPuzzle(int id) { _attempts = 0; _panel = id; }
+	void addAttempt() { _attempts++; }
+	void puzzleDone() { _areaDone++; _done++; }
+
+private:
+	static const int _AREA_SLOTS = 64, _AREA_LENGTH = 32;
+
+	std::atomic<int> _state, _panel, _area, _areaDone, _areaTotal, _done, _total, _attempts;
+	std::atomic<bool> _cancelled;
+	std::atomic<int> _areaCount;
+	wchar_t _areaNames[_AREA_SLOTS][_AREA_LENGTH]; //Area names are copied into a new slot and then published through _area, so a slot isn't changed while it can be read
+	std::wstring _error; //Written before the state is set to Failed
+	std::chrono::steady_clock::time_point _start;
+	std::thread _thread;
+};
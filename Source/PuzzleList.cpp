@@ -8,22 +8,7 @@
 void PuzzleList::GenerateAllN()
 {
 	generator->setLoadingData(336);
-	CopyTargets();
-	GenerateTutorialN();
-	GenerateSymmetryN();
-	GenerateQuarryN();
-	//GenerateBunkerN(); //Can't randomize because panels refuse to render the symbols
-	GenerateSwampN();
-	GenerateTreehouseN();
-	GenerateTownN();
-	GenerateVaultsN();
-	GenerateTrianglePanelsN();
-	GenerateOrchardN();
-	GenerateDesertN();
-	GenerateKeepN();
-	GenerateJungleN();
-	GenerateMountainN();
-	GenerateCavesN();
+	GenerateAreas(GetAreasN());
 	SetWindowText(_handle, L"Done!");
 	(new SymbolWatchdog(0x0056E))->start(); //Easy way to close the randomizer when the game is done
 	//GenerateShadowsN(); //Can't randomize
@@ -33,27 +18,268 @@ void PuzzleList::GenerateAllN()
 void PuzzleList::GenerateAllH()
 {
 	generator->setLoadingData(349);
-	CopyTargets();
-	GenerateTutorialH();
-	GenerateSymmetryH();
-	GenerateQuarryH();
-	//GenerateBunkerH(); //Can't randomize because panels refuse to render the symbols
-	GenerateSwampH();
-	GenerateTreehouseH();
-	GenerateTownH();
-	GenerateVaultsH();
-	GenerateTrianglePanelsH();
-	GenerateOrchardH();
-	GenerateDesertH();
-	GenerateKeepH();
-	GenerateJungleH();
-	GenerateMountainH();
-	GenerateCavesH();
+	GenerateAreas(GetAreasH());
 	SetWindowText(_handle, L"Done!");
 	//GenerateShadowsH(); //Can't randomize
 	//GenerateMonasteryH(); //Can't randomize
 }
 
+void PuzzleList::RegenerateN(const std::vector<std::wstring>& areas)
+{
+	generator->setLoadingData(0);
+	Regenerate(GetAreasN(), areas);
+}
+
+void PuzzleList::RegenerateH(const std::vector<std::wstring>& areas)
+{
+	generator->setLoadingData(0);
+	Regenerate(GetAreasH(), areas);
+}
+
+std::vector<std::wstring> PuzzleList::GetAreas(const std::vector<int>& panels)
+{
+	std::vector<std::wstring> areas;
+	for (int id : panels) {
+		const wchar_t* area = nullptr;
+		for (const auto& [name, ids] : GetAreaPanels()) {
+			if (std::find(ids.begin(), ids.end(), id) != ids.end()) area = name;
+		}
+		if (!area) throw std::exception("Panel isn't in an area that can be regenerated!");
+		areas.push_back(area);
+	}
+	return areas;
+}
+
+std::vector<PuzzleList::Area> PuzzleList::GetAreasN()
+{
+	return {
+		{ L"Targets", &PuzzleList::CopyTargets, { } },
+		{ L"Tutorial", &PuzzleList::GenerateTutorialN, { 0 } },
+		{ L"Symmetry", &PuzzleList::GenerateSymmetryN, { 0 } },
+		{ L"Quarry", &PuzzleList::GenerateQuarryN, { 0 } },
+		//{ L"Bunker", &PuzzleList::GenerateBunkerN, { 0 } }, //Can't randomize because panels refuse to render the symbols
+		{ L"Swamp", &PuzzleList::GenerateSwampN, { 0 } },
+		{ L"Treehouse", &PuzzleList::GenerateTreehouseN, { 0 } },
+		{ L"Town", &PuzzleList::GenerateTownN, { 0 } },
+		{ L"Vaults", &PuzzleList::GenerateVaultsN, { 0 } },
+		{ L"Triangle Panels", &PuzzleList::GenerateTrianglePanelsN, { 0 } },
+		{ L"Orchard", &PuzzleList::GenerateOrchardN, { 0 } },
+		{ L"Desert", &PuzzleList::GenerateDesertN, { 0 } },
+		{ L"Keep", &PuzzleList::GenerateKeepN, { 0 } },
+		{ L"Jungle", &PuzzleList::GenerateJungleN, { 0 } },
+		{ L"Mountain", &PuzzleList::GenerateMountainN, { 0, 2 } }, //Copies colors from a Symmetry Island panel
+		{ L"Caves", &PuzzleList::GenerateCavesN, { 0 } },
+	};
+}
+
+std::vector<PuzzleList::Area> PuzzleList::GetAreasH()
+{
+	return {
+		{ L"Targets", &PuzzleList::CopyTargets, { } },
+		{ L"Tutorial", &PuzzleList::GenerateTutorialH, { 0 } },
+		{ L"Symmetry", &PuzzleList::GenerateSymmetryH, { 0 } },
+		{ L"Quarry", &PuzzleList::GenerateQuarryH, { 0 }, 16 }, //16 throws out about the easiest quarter of small puzzles with a few symbols
+		//{ L"Bunker", &PuzzleList::GenerateBunkerH, { 0 } }, //Can't randomize because panels refuse to render the symbols
+		{ L"Swamp", &PuzzleList::GenerateSwampH, { 0 } },
+		{ L"Treehouse", &PuzzleList::GenerateTreehouseH, { 0 } },
+		{ L"Town", &PuzzleList::GenerateTownH, { 0 } },
+		{ L"Vaults", &PuzzleList::GenerateVaultsH, { 0 } },
+		{ L"Triangle Panels", &PuzzleList::GenerateTrianglePanelsH, { 0 }, 16 },
+		{ L"Orchard", &PuzzleList::GenerateOrchardH, { 0 } },
+		{ L"Desert", &PuzzleList::GenerateDesertH, { 0 } },
+		{ L"Keep", &PuzzleList::GenerateKeepH, { 0 } },
+		{ L"Jungle", &PuzzleList::GenerateJungleH, { 0 } },
+		{ L"Mountain", &PuzzleList::GenerateMountainH, { 0, 2 } }, //Copies colors from a Symmetry Island panel
+		{ L"Caves", &PuzzleList::GenerateCavesH, { 0 } },
+	};
+}
+
+//The panels each area writes puzzles or colors to, in either difficulty. Desert is the panels RandomizeDesert shuffles.
+const std::vector<std::pair<const wchar_t*, std::vector<int>>>& PuzzleList::GetAreaPanels()
+{
+	static const std::vector<std::pair<const wchar_t*, std::vector<int>>> areaPanels = {
+		{ L"Tutorial", {
+			0x00064, 0x00182, 0x00293, 0x00295, 0x002C2, 0x0A3B2, 0x0A3B5, 0x0A171, 0x04CA4, 0x0005D, 0x0005E, 0x0005F,
+			0x00060, 0x00061, 0x018AF, 0x0001B, 0x012C9, 0x0001C, 0x0001D, 0x0001E, 0x0001F, 0x00020, 0x00021, 0x03629
+		} },
+		{ L"Symmetry", {
+			0x00086, 0x00087, 0x00059, 0x00062, 0x0005C, 0x0008D, 0x00081, 0x00083, 0x00084, 0x00082, 0x0343A, 0x000B0,
+			0x00022, 0x00023, 0x00024, 0x00025, 0x00026, 0x0007C, 0x0007E, 0x00075, 0x00073, 0x00077, 0x00079, 0x00065,
+			0x0006D, 0x00072, 0x0006F, 0x00070, 0x00071, 0x00076, 0x00A52, 0x00A61, 0x00A57, 0x00A64, 0x00A5B, 0x00A68,
+			0x1C349
+		} },
+		{ L"Quarry", {
+			0x09E57, 0x17C09, 0x01E5A, 0x01E59, 0x00E0C, 0x01489, 0x0148A, 0x014D9, 0x014E7, 0x014E8, 0x00557, 0x005F1,
+			0x00620, 0x009F5, 0x0146C, 0x3C12D, 0x03686, 0x014E9, 0x0367C, 0x3C125, 0x034D4, 0x021D5, 0x021B3, 0x021B4,
+			0x021B0, 0x021AF, 0x021AE, 0x021B5, 0x021B6, 0x021B7, 0x021BB, 0x09DB5, 0x09DB1, 0x3C124, 0x09DB3, 0x09DB4,
+			0x0A3CB, 0x0A3CC, 0x0A3D0, 0x03612
+		} },
+		{ L"Swamp", {
+			0x0056E, 0x00469, 0x00472, 0x00262, 0x00474, 0x00553, 0x0056F, 0x00390, 0x010CA, 0x00983, 0x00984, 0x00986,
+			0x00985, 0x00987, 0x181A9, 0x00982, 0x0097F, 0x0098F, 0x00990, 0x17C0D, 0x17C0E, 0x00999, 0x0099D, 0x009A0,
+			0x009A1, 0x00007, 0x00008, 0x00009, 0x0000A, 0x003B2, 0x00A1E, 0x00C2E, 0x00E3A, 0x009A6, 0x009AB, 0x009AD,
+			0x009AE, 0x009AF, 0x00006, 0x00002, 0x00004, 0x00005, 0x013E6, 0x00596, 0x00001, 0x014D2, 0x014D4, 0x014D1,
+			0x17C05, 0x17C02, 0x00609, 0x18488, 0x181F5, 0x17C0A, 0x17E07
+		} },
+		{ L"Treehouse", {
+			0x02886, 0x17D72, 0x17D8F, 0x17D74, 0x17DAC, 0x17D9E, 0x17DB9, 0x17D9C, 0x17DC2, 0x17DC4, 0x0A182, 0x17DC8,
+			0x17DC7, 0x17CE4, 0x17D2D, 0x17D6C, 0x17D9B, 0x17D99, 0x17DAA, 0x17D97, 0x17BDF, 0x17D91, 0x17DC6, 0x17DB3,
+			0x17DB5, 0x17DB6, 0x17DC0, 0x17DD7, 0x17DD9, 0x17DB8, 0x17DDC, 0x17DD1, 0x17DDE, 0x17DE3, 0x17DEC, 0x17DAE,
+			0x17DB0, 0x17DDB, 0x17D88, 0x17DB4, 0x17D8C, 0x17CE3, 0x17DCD, 0x17DB2, 0x17DCC, 0x17DCA, 0x17D8E, 0x17DB7,
+			0x17DB1, 0x17DA2, 0x17E3C, 0x17E4D, 0x17E4F, 0x17E52, 0x17E5B, 0x17E5F, 0x17E61, 0x0288C
+		} },
+		{ L"Town", {
+			0x2899C, 0x28A33, 0x28ABF, 0x28AC0, 0x28AC1, 0x28AD9, 0x28AC7, 0x28AC8, 0x28ACA, 0x28ACB, 0x28ACC, 0x28998,
+			0x28A0D, 0x034E3, 0x03C0C, 0x03C08, 0x0A0C8, 0x17F89, 0x0A168, 0x33AB2, 0x334D8
+		} },
+		{ L"Vaults", {
+			0x033D4, 0x0CC7B, 0x002A6, 0x00AFB, 0x15ADD
+		} },
+		{ L"Triangle Panels", {
+			0x17D28, 0x3C12B, 0x17CF0, 0x17FA9, 0x17FA0, 0x17D27, 0x17CFB, 0x17D01, 0x17C71, 0x17CF7, 0x17C42, 0x17CE7,
+			0x17F9B, 0x17F93
+		} },
+		{ L"Orchard", {
+			0x032FF, 0x00143, 0x0003B, 0x00055, 0x032F7
+		} },
+		{ L"Desert", {
+			0x00698, 0x0048F, 0x09F92, 0x0A036, 0x09DA6, 0x0A049, 0x0A053, 0x09F94, 0x00422, 0x006E3, 0x0A02D, 0x00C72,
+			0x0129D, 0x008BB, 0x0078D, 0x18313, 0x04D18, 0x01205, 0x181AB, 0x0117A, 0x17ECA, 0x012D7
+		} },
+		{ L"Keep", {
+			0x033EA, 0x01BE9, 0x01CD3, 0x01D3F, 0x03317
+		} },
+		{ L"Jungle", {
+			0x0026F, 0x00C3F, 0x00C41, 0x014B2, 0x0026D, 0x0026E
+		} },
+		{ L"Mountain", {
+			0x17C34, 0x09E39, 0x09E73, 0x09E75, 0x09E78, 0x09E79, 0x09E6C, 0x09E6F, 0x09E6B, 0x09E7A, 0x09E71, 0x09E72,
+			0x09E69, 0x09E7B, 0x09EAD, 0x09EAF, 0x33AF5, 0x33AF7, 0x09F6E, 0x09FD3, 0x09FD4, 0x09FD6, 0x09FD7, 0x09FD8,
+			0x09FCC, 0x09FCE, 0x09FCF, 0x09FD0, 0x09FD1, 0x09FD2, 0x09E86, 0x09ED8, 0x0383D, 0x0383A, 0x0383F, 0x09E56,
+			0x03859, 0x09E5A, 0x339BB, 0x33961
+		} },
+		{ L"Caves", {
+			0x17FA2, 0x00FF8, 0x01A0D, 0x018A0, 0x009A4, 0x00A72, 0x00190, 0x00558, 0x00567, 0x006FE, 0x008B8, 0x00973,
+			0x0097B, 0x0097D, 0x0097E, 0x00994, 0x334D5, 0x00995, 0x00996, 0x00998, 0x32962, 0x32966, 0x01A31, 0x00B71,
+			0x288EA, 0x288FC, 0x289E7, 0x288AA, 0x0A16B, 0x0A2CE, 0x0A2D7, 0x0A2DD, 0x0A2EA, 0x17FB9, 0x0008F, 0x0006B,
+			0x0008B, 0x0008C, 0x0008A, 0x00089, 0x0006A, 0x0006C, 0x00027, 0x00028, 0x00029, 0x17CF2, 0x021D7, 0x09DD5,
+			0x0A16E, 0x039B4, 0x09E85
+		} },
+	};
+	return areaPanels;
+}
+
+//Generate the areas in order, or with area threads set, several at a time through a TaskGraph (each with its own generator).
+//Each area gets its own random stream, seeded from the seed and the area's place in the list, so an area's puzzles don't depend on the number of threads
+//or on the areas before it, and it can be generated again on its own (see Regenerate). selected - if not empty, only the areas marked in it are generated.
+//The progress for an area shows up on the loading handle once its panels are written, and in the Progress as the area generates.
+//Game writes and watchdogs that are held back (see Speculation and Regenerate) are only held back on this thread, so then the areas are always generated here.
+void PuzzleList::GenerateAreas(const std::vector<Area>& areas, const std::vector<bool>& selected)
+{
+	std::vector<int> areaSeeds; //Worked out first, since seeding the generator changes what they come out to
+	for (size_t i = 0; i < areas.size(); i++) areaSeeds.push_back(generator->attempt_seed(-1, static_cast<int>(i)));
+	if (areaThreads <= 0 || Memory::writeQueue || Watchdog::heldBack) {
+		//The pipeline writes straight to the game, so it can't be used while this thread's writes are held back
+		std::shared_ptr<Pipeline> pipeline = pipelineDepth > 0 && !Memory::writeQueue ? std::make_shared<Pipeline>(pipelineDepth) : nullptr;
+		generator->setPipeline(pipeline);
+		try {
+			for (size_t i = 0; i < areas.size(); i++) {
+				if (selected.size() && !selected[i]) continue;
+				generator->setAreaDifficulty(areas[i].minDifficulty, 0, _DIFFICULTY_TIME_BUDGET);
+				generator->resetConfig();
+				generator->seed(areaSeeds[i]);
+				(this->*areas[i].generate)();
+			}
+		}
+		catch (...) {
+			generator->setPipeline(nullptr);
+			generator->setAreaDifficulty(0, 0, 0);
+			throw;
+		}
+		generator->setPipeline(nullptr);
+		generator->setAreaDifficulty(0, 0, 0);
+		if (pipeline) pipeline->finish();
+		return;
+	}
+	TaskGraph graph;
+	std::vector<std::shared_ptr<PuzzleList>> lists;
+	std::vector<size_t> tasks(areas.size()); //The task for each area that is generated
+	for (size_t i = 0; i < areas.size(); i++) {
+		if (selected.size() && !selected[i]) continue;
+		std::shared_ptr<PuzzleList> list = std::make_shared<PuzzleList>();
+		list->seed = seed;
+		list->seedIsRNG = seedIsRNG;
+		list->colorblind = list->generator->colorblind = colorblind;
+		list->generator->_attemptThreads = generator->_attemptThreads > 0 ? 1 : 0; //Same random streams as with attempt threads, but the areas already keep the cores busy
+		list->generator->setTimeBudget(generator->_timeBudget, generator->_fallbacks);
+		list->generator->setProgress(generator->_progress);
+		lists.push_back(list);
+		list->generator->setAreaDifficulty(areas[i].minDifficulty, 0, _DIFFICULTY_TIME_BUDGET);
+		int areaSeed = areaSeeds[i];
+		void (PuzzleList::*generate)() = areas[i].generate;
+		std::vector<size_t> after;
+		for (size_t before : areas[i].after) after.push_back(tasks[before]); //Areas that are selected always have the areas they depend on selected too
+		tasks[i] = graph.add([list, generate, areaSeed]() {
+			list->generator->resetConfig();
+			list->generator->seed(areaSeed);
+			((*list).*generate)();
+		}, after);
+	}
+	std::shared_ptr<Progress> progress = generator->_progress;
+	generator->setProgress(nullptr); //The area generators report to it themselves
+	try {
+		graph.run(areaThreads, [&](size_t i) {
+			std::shared_ptr<Generate> areaGenerator = lists[i]->generator;
+			if (areaGenerator->_areaPuzzles) generator->setLoadingData(areaGenerator->_areaName, areaGenerator->_areaPuzzles);
+			for (int n = 0; n < areaGenerator->_genTotal; n++) generator->incrementProgress();
+		});
+	}
+	catch (...) {
+		generator->setProgress(progress);
+		throw;
+	}
+	generator->setProgress(progress);
+}
+
+//Generate the named areas and the areas they depend on, keeping the watchdogs and panel lists as they were
+void PuzzleList::Regenerate(const std::vector<Area>& areas, const std::vector<std::wstring>& names)
+{
+	std::vector<bool> selected(areas.size(), false);
+	for (const std::wstring& name : names) {
+		size_t i = 0;
+		while (i < areas.size() && name != areas[i].name) i++;
+		if (i == areas.size()) throw std::exception("Couldn't find an area with that name!");
+		selected[i] = true;
+	}
+	for (size_t i = areas.size(); i-- > 0;) { //Areas only depend on earlier ones
+		if (selected[i]) for (size_t before : areas[i].after) selected[before] = true;
+	}
+	size_t numPanels, numCustom;
+	{
+		std::lock_guard<std::mutex> lock(Panel::registryMutex);
+		numPanels = Panel::generatedPanels.size();
+		numCustom = Panel::customSymbolPuzzles.size();
+	}
+	//The watchdogs started the first time are still running, and the puzzles come out the same, so the new ones aren't needed
+	std::vector<Watchdog*> watchdogs;
+	Watchdog::heldBack = &watchdogs;
+	std::exception_ptr error;
+	try {
+		GenerateAreas(areas, selected);
+	}
+	catch (...) {
+		error = std::current_exception();
+	}
+	Watchdog::heldBack = nullptr;
+	for (Watchdog* watchdog : watchdogs) delete watchdog;
+	{
+		std::lock_guard<std::mutex> lock(Panel::registryMutex);
+		Panel::generatedPanels.erase(Panel::generatedPanels.begin() + numPanels, Panel::generatedPanels.end());
+		Panel::customSymbolPuzzles.erase(Panel::customSymbolPuzzles.begin() + numCustom, Panel::customSymbolPuzzles.end());
+	}
+	if (error) std::rethrow_exception(error);
+}
+
 void PuzzleList::CopyTargets()
 {
 	Special::copyTarget(0x00021, 0x19650);
@@ -352,8 +578,11 @@ void PuzzleList::GenerateSwampN()
 	generator->setFlagOnce(Generate::Config::DisableReset);
 	generator->setFlagOnce(Generate::Config::DisconnectShapes);
 	generator->generate(0x17C0D, Decoration::Poly, 3);
-	generator->place_gaps(15);
-	generator->write(0x17C0E);
+	if (generator->_skipped.count(0x17C0D)) generator->skip(0x17C0E); //It would be a copy of a puzzle that wasn't made
+	else {
+		generator->place_gaps(15);
+		generator->write(0x17C0E);
+	}
 	//Disconnected Shapes
 	generator->resetConfig();
 	generator->setGridSize(4, 4);
@@ -512,15 +741,14 @@ void PuzzleList::GenerateTreehouseN()
 	generator->generate(0x17DB4, Decoration::Star | Decoration::Color::Orange, 2, Decoration::Star | Decoration::Color::Magenta, 2, Decoration::Stone | Decoration::Color::Orange, 2, Decoration::Stone | Decoration::Color::Magenta, 2);
 	generator->generate(0x17D8C, Decoration::Star | Decoration::Color::Orange, 3, Decoration::Star | Decoration::Color::Magenta, 2, Decoration::Stone | Decoration::Color::Orange, 2, Decoration::Stone | Decoration::Color::Magenta, 2);
 	generator->setGridSize(4, 4);
-	generator->generate(0x17CE3, Decoration::Star | Decoration::Color::Orange, 2, Decoration::Star | Decoration::Color::Magenta, 2, Decoration::Stone | Decoration::Color::Orange, 1, Decoration::Stone | Decoration::Color::Magenta, 1);
+	specialCase->generatePivotPanel(0x17CE3, { 4, 4 }, { { Decoration::Star | Decoration::Color::Orange, 2 },{ Decoration::Star | Decoration::Color::Magenta, 2 },{ Decoration::Stone | Decoration::Color::Orange, 1 },{ Decoration::Stone | Decoration::Color::Magenta, 1 } }, generator->colorblind);
 	generator->generate(0x17DCD, Decoration::Star | Decoration::Color::Orange, 2, Decoration::Star | Decoration::Color::Magenta, 3, Decoration::Stone | Decoration::Color::Orange, 3, Decoration::Stone | Decoration::Color::Magenta, 2);
 	generator->generate(0x17DB2, Decoration::Star | Decoration::Color::Orange, 3, Decoration::Star | Decoration::Color::Magenta, 2, Decoration::Stone | Decoration::Color::Orange, 2, Decoration::Stone | Decoration::Color::Magenta, 3);
 	generator->generate(0x17DCC, Decoration::Star | Decoration::Color::Orange, 3, Decoration::Star | Decoration::Color::Magenta, 2, Decoration::Stone | Decoration::Color::Orange, 2, Decoration::Stone | Decoration::Color::Magenta, 3);
 	generator->generate(0x17DCA, Decoration::Star | Decoration::Color::Orange, 3, Decoration::Star | Decoration::Color::Magenta, 3, Decoration::Star | Decoration::Color::Green, 2, Decoration::Stone | Decoration::Color::Orange, 1, Decoration::Stone | Decoration::Color::Magenta, 2, Decoration::Stone | Decoration::Color::Green, 2);
 	generator->generate(0x17D8E, Decoration::Star | Decoration::Color::Orange, 2, Decoration::Star | Decoration::Color::Magenta, 2, Decoration::Star | Decoration::Color::Green, 3, Decoration::Stone | Decoration::Color::Orange, 2, Decoration::Stone | Decoration::Color::Magenta, 2, Decoration::Stone | Decoration::Color::Green, 1);
-	generator->setFlagOnce(Generate::Config::FixBackground);
+	specialCase->generatePivotPanel(0x17DB7, { 4, 4 }, { { Decoration::Star | Decoration::Color::Orange, 4 },{ Decoration::Star | Decoration::Color::Magenta, 4 },{ Decoration::Star | Decoration::Color::Green, 2 } }, generator->colorblind);
 	generator->setGridSize(4, 4);
-	generator->generate(0x17DB7, Decoration::Star | Decoration::Color::Orange, 4, Decoration::Star | Decoration::Color::Magenta, 4, Decoration::Star | Decoration::Color::Green, 2);
 	generator->generate(0x17DB1, Decoration::Star | Decoration::Color::Orange, 2, Decoration::Star | Decoration::Color::Magenta, 4, Decoration::Star | Decoration::Color::Green, 2, Decoration::Stone | Decoration::Color::Orange, 3, Decoration::Stone | Decoration::Color::Magenta, 3, Decoration::Stone | Decoration::Color::Green, 2);
 	generator->generate(0x17DA2, Decoration::Star | Decoration::Color::Orange, 2, Decoration::Star | Decoration::Color::Magenta, 3, Decoration::Star | Decoration::Color::Green, 2, Decoration::Stone | Decoration::Color::Orange, 2, Decoration::Stone | Decoration::Color::Magenta, 3, Decoration::Stone | Decoration::Color::Green, 4);
 	//Green Bridge
@@ -1403,8 +1631,11 @@ void PuzzleList::GenerateSwampH()
 	generator->setFlagOnce(Generate::Config::LongPath);
 	generator->setSymbol(Decoration::Start, 4, 6);
 	generator->generate(0x17C0D, Decoration::Stone | Decoration::Color::White, 1, Decoration::Stone | Decoration::Color::Cyan, 1, Decoration::Stone | Decoration::Color::Green, 1, Decoration::Mine, 3);
-	generator->place_gaps(9);
-	generator->write(0x17C0E);
+	if (generator->_skipped.count(0x17C0D)) generator->skip(0x17C0E); //It would be a copy of a puzzle that wasn't made
+	else {
+		generator->place_gaps(9);
+		generator->write(0x17C0E);
+	}
 	//Disconnected Shapes
 	generator->resetConfig();
 	generator->setFlag(Generate::Config::DisconnectShapes);
@@ -1790,11 +2021,13 @@ void PuzzleList::GenerateVaultsH()
 	//Tutorial Vault
 	generator->arrowColor = { 0.8f, 0.8f, 0.8f, 1 };
 	generator->setGridSize(6, 6);
+	generator->setMaxSolutions(1, 500);
 	generator->generate(0x033D4, Decoration::Start, 5, Decoration::Pointer, 5, Decoration::Antitriangle, 5);
 	//Desert Vault
 	generator->resetConfig();
 	generator->arrowColor = { 1, 1, 0, 1 };
 	generator->setGridSize(7, 7);
+	generator->setMaxSolutions(1, 500);
 	generator->generate(0x0CC7B, Decoration::Start, 1, Decoration::Dot_Intersection, 64, 
 		Decoration::Dart, 8, Decoration::Head, 8);
 	//Symmetry Vault
@@ -2,6 +2,8 @@
 #include "Generate.h"
 #include "Special.h"
 #include "Random.h"
+#include "Pipeline.h"
+#include "TaskGraph.h"
 
 class PuzzleList {
 
@@ -9,6 +11,13 @@ public:
 
 	void GenerateAllN();
 	void GenerateAllH();
+	//Generate some of the areas again (e.g. L"Swamp", see GetAreasN), along with the areas they read panels from. With the same seed, each area
+	//comes out the same as it did from GenerateAllN/GenerateAllH, since areas have their own random streams, and the other areas aren't touched.
+	//The watchdogs the areas start are thrown away, since the ones from the first time are watching the same puzzles.
+	void RegenerateN(const std::vector<std::wstring>& areas);
+	void RegenerateH(const std::vector<std::wstring>& areas);
+	//The area each panel is in (see GetAreaPanels). Throws if a panel isn't in one of the areas.
+	static std::vector<std::wstring> GetAreas(const std::vector<int>& panels);
 
 	PuzzleList() {
 		generator = std::make_shared<Generate>();
@@ -34,6 +43,17 @@ public:
 		generator->colorblind = colorblind;
 	}
 
+	//See Generate::setAttemptThreads
+	void setAttemptThreads(int threads) { generator->setAttemptThreads(threads); }
+	//0 - generate the areas one after another (the default). Above 0 - generate this many areas at once (see GenerateAreas)
+	void setAreaThreads(int threads) { areaThreads = threads; }
+	//0 - write each puzzle before generating the next (the default). Above 0 - when areas are generated one after another, write puzzles through a Pipeline holding up to this many.
+	//Since the areas are generated one after another only without area threads or while watchdogs are held back, the Randomizer's pipeline is only used by Regenerate.
+	void setPipelineDepth(int depth) { pipelineDepth = depth; }
+	//Milliseconds each puzzle gets before falling back to an easier one (see Generate::setTimeBudget). 0 for no limit (the default).
+	void setTimeBudget(double milliseconds) { generator->setTimeBudget(milliseconds); }
+	void setProgress(std::shared_ptr<Progress> progress) { generator->setProgress(progress); }
+
 	void CopyTargets();
 
 	//--------------------------Normal difficulty---------------------------
@@ -81,12 +101,31 @@ public:
 	void GenerateJungleH();
 
 private:
+	//One step of generating the game, and the steps before it (by index) that write panels it reads
+	struct Area {
+		const wchar_t* name;
+		void (PuzzleList::*generate)();
+		std::vector<size_t> after;
+		double minDifficulty = 0; //Puzzles in the area that score lower than this are thrown out (see Generate::setAreaDifficulty)
+	};
+
+	static std::vector<Area> GetAreasN();
+	static std::vector<Area> GetAreasH();
+	void GenerateAreas(const std::vector<Area>& areas, const std::vector<bool>& selected = {});
+	void Regenerate(const std::vector<Area>& areas, const std::vector<std::wstring>& names);
+	static const std::vector<std::pair<const wchar_t*, std::vector<int>>>& GetAreaPanels();
+
+	static constexpr double _DIFFICULTY_TIME_BUDGET = 200; //Milliseconds the solver gets to score each puzzle in an area with a minimum difficulty. Puzzles it can't finish are kept.
+
 	std::shared_ptr<Generate> generator;
 	std::shared_ptr<Special> specialCase;
 	HWND _handle = nullptr;
 	int seed = 0;
 	bool seedIsRNG = false;
 	bool colorblind = false;
+	int areaThreads = 0;
+	int pipelineDepth = 0;
+
 
 	template <class T> T pick_random(std::vector<T>& vec) { return vec[Random::rand() % vec.size()]; }
 	template <class T> T pick_random(std::set<T>& set) { auto it = set.begin(); std::advance(it, Random::rand() % set.size()); return *it; }
@@ -5,4 +5,4 @@
 #include "Random.h"
 #include <time.h>
 
-std::mt19937 Random::gen = std::mt19937((int)time(0));
\ No newline at end of file
+thread_local std::mt19937 Random::gen = std::mt19937((int)time(0));
\ No newline at end of file
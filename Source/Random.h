@@ -4,7 +4,7 @@
 
 struct Random {
 
-	static std::mt19937 gen;
+	static thread_local std::mt19937 gen; //Each thread has its own stream, so generators can run side by side
 
 	static void seed(int val) {
 		gen = std::mt19937(val);
@@ -9,6 +9,7 @@
 #include <string>
 #include <iostream>
 #include <numeric>
+#include <thread>
 #include "Random.h"
 #include "Quaternion.h"
 
@@ -23,30 +24,56 @@ std::vector<int> copyWithoutElements(const std::vector<int>& input, const std::v
 	return result;
 }
 
-void Randomizer::GenerateNormal(HWND loadingHandle) {
+void Randomizer::GenerateNormal(HWND loadingHandle, std::shared_ptr<Progress> progress) {
+	GeneratePuzzles(false, loadingHandle, progress);
+	Finish(loadingHandle, progress);
+}
+
+void Randomizer::GenerateHard(HWND loadingHandle, std::shared_ptr<Progress> progress) {
+	GeneratePuzzles(true, loadingHandle, progress);
+	Finish(loadingHandle, progress);
+}
+
+void Randomizer::GeneratePuzzles(bool hard, HWND loadingHandle, std::shared_ptr<Progress> progress) {
 	std::shared_ptr<PuzzleList> puzzles = std::make_shared<PuzzleList>();
 	puzzles->setLoadingHandle(loadingHandle);
-	puzzles->setSeed(seed, seedIsRNG, colorblind);
-	puzzles->GenerateAllN();
+	SetupPuzzles(*puzzles, progress);
+	Memory::StartWriteBehind();
+	if (hard) puzzles->GenerateAllH();
+	else puzzles->GenerateAllN();
 	if (doubleMode) ShufflePanels(true);
+}
+
+void Randomizer::Finish(HWND loadingHandle, std::shared_ptr<Progress> progress) {
+	Memory::FlushWrites();
+	if (progress) progress->setArea(L"Starting watchdogs...", 0);
 	SetWindowText(loadingHandle, L"Starting watchdogs...");
 	Panel::StartSymbolWatchdogs(_shuffleMapping);
 	SetWindowText(loadingHandle, L"Done!");
-	if (!Special::hasBeenRandomized())
-		MessageBox(GetActiveWindow(), L"Welcome to the abyss.", L"Go.", MB_OK);
 }
 
-void Randomizer::GenerateHard(HWND loadingHandle) {
+void Randomizer::Regenerate(bool hard, const std::vector<std::wstring>& areas, const std::vector<int>& panels, std::shared_ptr<Progress> progress) {
+	if (doubleMode) throw std::exception("Can't regenerate areas in Double Mode, since the puzzles were shuffled!");
+	std::vector<std::wstring> names = areas;
+	for (const std::wstring& area : PuzzleList::GetAreas(panels)) names.push_back(area);
 	std::shared_ptr<PuzzleList> puzzles = std::make_shared<PuzzleList>();
-	puzzles->setLoadingHandle(loadingHandle);
-	puzzles->setSeed(seed, seedIsRNG, colorblind);
-	puzzles->GenerateAllH();
-	if (doubleMode) ShufflePanels(true);
-	SetWindowText(loadingHandle, L"Starting watchdogs...");
-	Panel::StartSymbolWatchdogs(_shuffleMapping);
-	SetWindowText(loadingHandle, L"Done!");
-	if (!Special::hasBeenRandomized())
-		MessageBox(GetActiveWindow(), L"Welcome to the abyss.", L"Go.", MB_OK);
+	SetupPuzzles(*puzzles, progress);
+	Memory::StartWriteBehind();
+	if (hard) puzzles->RegenerateH(names);
+	else puzzles->RegenerateN(names);
+	Memory::FlushWrites();
+}
+
+void Randomizer::SetupPuzzles(PuzzleList& puzzles, std::shared_ptr<Progress> progress) {
+	puzzles.setProgress(progress);
+	puzzles.setSeed(seed, seedIsRNG, colorblind);
+	//With any number of threads, each area and each attempt gets its own random stream, so a seed makes the same puzzles on every computer.
+	//Those streams aren't the ones earlier versions used, so a seed doesn't make the same puzzles it did in them.
+	int threads = static_cast<int>(std::thread::hardware_concurrency());
+	puzzles.setAttemptThreads(threads > 0 ? threads : 1);
+	puzzles.setAreaThreads(threads > 0 ? threads : 1);
+	puzzles.setPipelineDepth(_PIPELINE_DEPTH);
+	puzzles.setTimeBudget(_TIME_BUDGET);
 }
 
 template <class T>
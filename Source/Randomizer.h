@@ -1,13 +1,23 @@
 #pragma once
 #include "Memory.h"
+#include "Progress.h"
 #include <memory>
 #include <set>
 #include <map>
 
+class PuzzleList;
+
 class Randomizer {
 public:
-	void GenerateNormal(HWND loadingHandle);
-	void GenerateHard(HWND loadingHandle);
+	//progress - if set, gets the progress and is checked for cancellation (e.g. when generating on a thread other than the UI's, with a null loading handle)
+	void GenerateNormal(HWND loadingHandle, std::shared_ptr<Progress> progress = nullptr);
+	void GenerateHard(HWND loadingHandle, std::shared_ptr<Progress> progress = nullptr);
+	//The two halves of GenerateNormal/GenerateHard, so the puzzles can be made before it is time to start the watchdogs (see Speculation)
+	void GeneratePuzzles(bool hard, HWND loadingHandle, std::shared_ptr<Progress> progress = nullptr);
+	void Finish(HWND loadingHandle, std::shared_ptr<Progress> progress = nullptr); //Wait for the puzzles to reach the game, then start the watchdogs
+	//Generate some areas of a randomized game again, along with the areas the panels are in, getting the same puzzles as before (see PuzzleList::RegenerateN).
+	//Not for Double Mode, since the puzzles were shuffled between areas after they were generated.
+	void Regenerate(bool hard, const std::vector<std::wstring>& areas, const std::vector<int>& panels, std::shared_ptr<Progress> progress = nullptr);
 
 	void AdjustSpeed();
 
@@ -27,6 +37,12 @@ public:
 	bool doubleMode = false;
 
 private:
+	//Milliseconds for each step of a puzzle's fallback ladder (see PuzzleList::setTimeBudget). Long enough that only a stuck puzzle runs out, since a puzzle that does depends on the computer's speed.
+	static constexpr double _TIME_BUDGET = 5000;
+	static const int _PIPELINE_DEPTH = 4; //Puzzles that can be waiting to be written (see PuzzleList::setPipelineDepth)
+	//Settings that GeneratePuzzles and Regenerate need to share to make the same puzzles. Turns on attempt threads, area threads and the pipeline for every run,
+	//so seeds make different puzzles than in versions without them (see Generate::setAttemptThreads).
+	void SetupPuzzles(PuzzleList& puzzles, std::shared_ptr<Progress> progress);
 	void RandomizeDesert();
 
 	void Randomize(std::vector<int>& panels, int flags);
@@ -45,6 +61,7 @@ private:
 	friend class Panel;
 	friend class PuzzleList;
 	friend class Special;
+	friend class Speculation;
 };
 
 #define ORIENTATION 0x34
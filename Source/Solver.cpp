@@ -0,0 +1,543 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "Solver.h"
+#include <algorithm>
+#include <random>
+
+const int Solver::_DIRECTIONS[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+
+//Symbols that the game checks by itself. The custom symbols are left to SymbolChecker.
+static bool is_standard_symbol(int symbol) {
+	if (symbol & 0xF000000) return false;
+	int type = symbol & 0xF00;
+	return type == Decoration::Stone || type == Decoration::Star || type == Decoration::Poly || type == Decoration::Eraser || type == Decoration::Triangle;
+}
+
+Solver::Solver(const std::vector<std::vector<int>>& grid, const std::set<Point>& starts, const std::set<Point>& exits, int pillarWidth) : _pathChecker(grid, pillarWidth)
+{
+	_grid = grid;
+	_width = static_cast<int>(grid.size());
+	_height = static_cast<int>(grid[0].size());
+	_pillarWidth = pillarWidth;
+	_starts = std::vector<Point>(starts.begin(), starts.end());
+	_hasErasers = _hasCustomSymbols = _hasColoredDots = false;
+	_maxSolutions = 0;
+	_keepSolutions = true;
+	_hasDeadline = false;
+	_splitDepth = 0;
+	_sharedSolutions = nullptr;
+	_stats = SolverStats();
+	_hash = 0;
+	//The bitboards hold the grid points directly, so a bigger panel can't be searched at all
+	_tooBig = _width > Bitboard::SIZE || _height > Bitboard::SIZE;
+	std::mt19937_64 rng(0x5eed);
+	for (int y = 0; y < Bitboard::SIZE; y++) {
+		for (int x = 0; x < Bitboard::SIZE; x++) {
+			_zobrist[0][x][y] = rng();
+			_zobrist[1][x][y] = rng();
+			_zobristHead[x][y] = rng();
+		}
+	}
+	_checker.pillarWidth = pillarWidth;
+	if (_tooBig) return;
+	for (int x = 0; x < _width; x++) {
+		for (int y = 0; y < _height; y++) {
+			int value = grid[x][y];
+			if (x % 2 == 1 && y % 2 == 1) {
+				if ((value & 0xF000000) || (value & 0xF00) == Decoration::Arrow) _hasCustomSymbols = true;
+				else if ((value & 0xF00) == Decoration::Eraser) _hasErasers = true;
+				continue;
+			}
+			if (value == OPEN || (value & GAP) || (value & NO_POINT)) continue;
+			_passable.set(x, y);
+			if (value & DOT) _dots.set(x, y);
+			if ((value & DOT) && (value & (DOT_IS_BLUE | DOT_IS_ORANGE))) _hasColoredDots = true;
+		}
+	}
+	for (Point p : exits) _exits.set(p.first, p.second);
+}
+
+void Solver::set_symmetry(const std::vector<std::vector<Point>>& symmetry)
+{
+	_symmetry = symmetry;
+}
+
+int Solver::solve(int maxSolutions)
+{
+	run(maxSolutions, 0, true);
+	return _stats.solutions;
+}
+
+int Solver::count_solutions(int limit, double timeBudget)
+{
+	run(limit, timeBudget, false);
+	return _stats.solutions;
+}
+
+void Solver::begin(int maxSolutions, double timeBudget, bool keepSolutions)
+{
+	_stats = SolverStats();
+	_solutions.clear();
+	_deadStates.clear();
+	_maxSolutions = maxSolutions;
+	_keepSolutions = keepSolutions;
+	_hasDeadline = timeBudget > 0;
+	_deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<long long>(timeBudget * 1000));
+}
+
+void Solver::run(int maxSolutions, double timeBudget, bool keepSolutions)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	begin(maxSolutions, timeBudget, keepSolutions);
+	if (_tooBig) {
+		//Nothing is known about the solutions, the same as running out of time before the search is done
+		_stats.timedOut = true;
+		return;
+	}
+	bool symmetric = !_symmetry.empty();
+	for (Point start : _starts) {
+		if (!is_free(start)) continue;
+		Point symStart = start;
+		if (symmetric) {
+			symStart = _symmetry[start.first][start.second];
+			if (symStart == start || !is_free(symStart) || std::find(_starts.begin(), _starts.end(), symStart) == _starts.end()) continue;
+			//Without colored dots, starting from either end of the pair draws the same picture
+			if (!_hasColoredDots && symStart < start) continue;
+		}
+		visit(start, false);
+		if (symmetric) visit(symStart, true);
+		search(start, symStart);
+		if (symmetric) unvisit(symStart, true);
+		unvisit(start, false);
+		if (stopped()) break;
+	}
+	_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+//Collect every line that makes it to the given number of points, to be searched separately with search_from.
+//Solutions shorter than that are counted here.
+void Solver::split(size_t depth, int maxSolutions, double timeBudget)
+{
+	_splitDepth = depth;
+	_tasks.clear();
+	run(maxSolutions, timeBudget, false);
+	_splitDepth = 0;
+}
+
+void Solver::search_from(const std::vector<Point>& prefix)
+{
+	bool symmetric = !_symmetry.empty();
+	for (Point p : prefix) {
+		visit(p, false);
+		if (symmetric) visit(_symmetry[p.first][p.second], true);
+	}
+	Point last = prefix.back();
+	search(last, symmetric ? _symmetry[last.first][last.second] : last);
+	for (auto it = prefix.rbegin(); it != prefix.rend(); ++it) {
+		if (symmetric) unvisit(_symmetry[it->first][it->second], true);
+		unvisit(*it, false);
+	}
+}
+
+bool Solver::check_path(const std::vector<Point>& path)
+{
+	if (_tooBig) return false;
+	bool symmetric = !_symmetry.empty();
+	bool valid = true;
+	for (Point p : path) {
+		Point sp = symmetric ? _symmetry[p.first][p.second] : p;
+		if (_visited.get(p.first, p.second) || (symmetric && (sp == p || _visited.get(sp.first, sp.second)))) {
+			valid = false;
+			break;
+		}
+		visit(p, false);
+		if (symmetric) visit(sp, true);
+	}
+	if (valid) valid = validate();
+	_visited = _symVisited = Bitboard();
+	_path.clear();
+	_symPath.clear();
+	_hash = 0;
+	return valid;
+}
+
+//Lines that cover the same points and end at the same place have the same ways to finish,
+//so once one of them turns out to have no solutions, the rest can be skipped.
+void Solver::search(Point pos, Point symPos)
+{
+	uint64_t state = _hash ^ _zobristHead[pos.first][pos.second];
+	if (_deadStates.count(state)) return;
+	if ((++_stats.nodes & 0x3ff) == 0 && _hasDeadline && std::chrono::steady_clock::now() > _deadline) _stats.timedOut = true;
+	if (_stats.timedOut) return;
+	if (_splitDepth && _path.size() >= _splitDepth) {
+		_tasks.push_back(_path);
+		return;
+	}
+	int found = _stats.solutions;
+	bool symmetric = !_symmetry.empty();
+	bool solved = false;
+	if (_exits.get(pos.first, pos.second) && (!symmetric || _exits.get(symPos.first, symPos.second)) && validate()) {
+		if (_keepSolutions) _solutions.push_back(_path);
+		_stats.solutions++;
+		if (_sharedSolutions) _sharedSolutions->fetch_add(1, std::memory_order_relaxed);
+		if (stopped()) return;
+		_stats.solutionLength += _path.size();
+		solved = true;
+	}
+	int moves = can_finish(pos, symPos) ? search_moves(pos) : 0;
+	_stats.moves += moves;
+	if (moves > 0) _stats.expandedNodes++;
+	if (moves == 1) _stats.forcedNodes++;
+	if (moves == 0 && !solved) {
+		_stats.deadEnds++;
+		_stats.deadEndLength += _path.size();
+	}
+	if (_stats.solutions == found && !stopped() && !_splitDepth && _deadStates.size() < _MAX_DEAD_STATES) _deadStates.insert(state);
+}
+
+//Returns the number of moves that were searched
+int Solver::search_moves(Point pos)
+{
+	bool symmetric = !_symmetry.empty();
+	int moves = 0;
+	for (int dir = 0; dir < 4; dir++) {
+		Point next, symNext;
+		if (!move(pos, dir, next) || !is_free(next)) continue;
+		if (symmetric) {
+			symNext = _symmetry[next.first][next.second];
+			if (symNext == next || !is_free(symNext)) continue;
+		}
+		visit(next, false);
+		if (symmetric) visit(symNext, true);
+		if (!_pathChecker.violated()) {
+			moves++;
+			search(next, symNext);
+		}
+		if (symmetric) unvisit(symNext, true);
+		unvisit(next, false);
+		if (stopped()) break;
+	}
+	return moves;
+}
+
+//Get the point one step from pos in the given direction. Returns false if it is off the grid.
+bool Solver::move(Point pos, int dir, Point& next) const
+{
+	int x = wrap(pos.first + _DIRECTIONS[dir][0]), y = pos.second + _DIRECTIONS[dir][1];
+	if (x < 0 || y < 0 || x >= _width || y >= _height) return false;
+	next = Point(x, y);
+	return true;
+}
+
+bool Solver::is_free(Point pos) const
+{
+	return _passable.get(pos.first, pos.second) && !_visited.get(pos.first, pos.second);
+}
+
+void Solver::visit(Point pos, bool sym)
+{
+	_visited.set(pos.first, pos.second);
+	_pathChecker.push(pos);
+	_hash ^= _zobrist[sym][pos.first][pos.second];
+	if (sym) {
+		_symVisited.set(pos.first, pos.second);
+		_symPath.push_back(pos);
+	}
+	else _path.push_back(pos);
+}
+
+void Solver::unvisit(Point pos, bool sym)
+{
+	_visited.reset(pos.first, pos.second);
+	_pathChecker.pop();
+	_hash ^= _zobrist[sym][pos.first][pos.second];
+	if (sym) {
+		_symVisited.reset(pos.first, pos.second);
+		_symPath.pop_back();
+	}
+	else _path.pop_back();
+}
+
+//All points the line could still get to from the given point
+Bitboard Solver::reach(Point from) const
+{
+	Bitboard free = _passable, region, last;
+	for (int y = 0; y < _height; y++) free.rows[y] &= ~_visited.rows[y];
+	region.set(from.first, from.second);
+	do {
+		last = region;
+		for (int y = 0; y < _height; y++) {
+			uint32_t row = region.rows[y];
+			uint32_t spread = row << 1 | row >> 1;
+			if (_pillarWidth) spread |= row >> (_width - 1) | (row & 1) << (_width - 1);
+			if (y > 0) spread |= region.rows[y - 1];
+			if (y + 1 < _height) spread |= region.rows[y + 1];
+			region.rows[y] |= spread & free.rows[y];
+		}
+	} while (region != last);
+	return region;
+}
+
+//Whether the line can still get to an exit and pick up all of the remaining dots
+bool Solver::can_finish(Point pos, Point symPos) const
+{
+	Bitboard reachable = reach(pos), exits = reachable;
+	exits &= _exits;
+	if (!exits.any()) return false;
+	if (!_symmetry.empty()) {
+		Bitboard symReachable = reach(symPos), symExits = symReachable;
+		symExits &= _exits;
+		if (!symExits.any()) return false;
+		reachable |= symReachable;
+	}
+	if (!_hasErasers) { //A missed dot could be erased
+		for (int y = 0; y < _height; y++) {
+			if (_dots.rows[y] & ~_visited.rows[y] & ~reachable.rows[y]) return false;
+		}
+	}
+	if (closes_region(pos) || (!_symmetry.empty() && closes_region(symPos))) return _pathChecker.check_sealed(reachable);
+	return true;
+}
+
+//Whether the line just touched the edge of the panel, a hole in it, or itself. A new region can only be closed off this way.
+bool Solver::closes_region(Point pos) const
+{
+	int x = pos.first, y = pos.second;
+	if (x % 2 || y % 2) return false;
+	if (y == 0 || y + 1 == _height || (!_pillarWidth && (x == 0 || x + 1 == _width))) return true;
+	for (int dir = 0; dir < 4; dir++) {
+		Point edge, vertex;
+		if (move(pos, dir, edge) && move(edge, dir, vertex) && !_visited.get(edge.first, edge.second) && _visited.get(vertex.first, vertex.second)) return true;
+		int cx = wrap(x + (dir < 2 ? 1 : -1)), cy = y + (dir % 2 ? 1 : -1);
+		if (cx >= 0 && cx < _width && (_grid[cx][cy] & Decoration::Empty) == Decoration::Empty) return true;
+	}
+	return false;
+}
+
+int Solver::count_path_edges(int x, int y) const
+{
+	int count = 0;
+	if (_visited.get(wrap(x - 1), y)) count++;
+	if (_visited.get(wrap(x + 1), y)) count++;
+	if (_visited.get(x, y - 1)) count++;
+	if (_visited.get(x, y + 1)) count++;
+	return count;
+}
+
+//Check the current line against every symbol on the panel
+bool Solver::validate()
+{
+	bool symmetric = !_symmetry.empty();
+	std::vector<std::vector<int>> grid = _grid;
+	for (int x = 0; x < _width; x++) {
+		for (int y = 0; y < _height; y++) {
+			if (!_visited.get(x, y)) continue;
+			grid[x][y] = PATH;
+			//Colored dots have to be collected by the matching line
+			if (symmetric && _dots.get(x, y)) {
+				if ((_grid[x][y] & DOT_IS_BLUE) && _symVisited.get(x, y)) return false;
+				if ((_grid[x][y] & DOT_IS_ORANGE) && !_symVisited.get(x, y)) return false;
+			}
+		}
+	}
+	if (_hasCustomSymbols) {
+		_checker.set_grid(grid);
+		if (!_checker.check_all()) return false;
+	}
+	RegionKernel kernel(grid, Point(1, 1), _pillarWidth > 0, false);
+	kernel.label_regions();
+	std::vector<std::vector<Point>> items(kernel.get_regions().size());
+	for (int x = 1; x < _width; x += 2) {
+		for (int y = 1; y < _height; y += 2) {
+			int label = kernel.get_label(Point(x, y));
+			if (label >= 0 && is_standard_symbol(_grid[x][y])) items[label].emplace_back(Point(x, y));
+		}
+	}
+	//A dot the line missed belongs to the region around it, where an eraser could remove it
+	for (int x = 0; x < _width; x++) {
+		for (int y = 0; y < _height; y++) {
+			if (!_dots.get(x, y) || _visited.get(x, y)) continue;
+			if (!_hasErasers) return false;
+			int label = -1;
+			for (int dx = -1; dx <= 1 && label < 0; dx++) {
+				for (int dy = -1; dy <= 1 && label < 0; dy++) {
+					if ((x + dx) % 2 == 0 || (y + dy) % 2 == 0) continue;
+					label = kernel.get_label(Point(wrap(x + dx), y + dy));
+				}
+			}
+			if (label < 0) return false;
+			items[label].emplace_back(Point(x, y));
+		}
+	}
+	const std::vector<Bitboard>& regions = kernel.get_regions();
+	for (size_t i = 0; i < regions.size(); i++) {
+		if (items[i].size() && !check_region(items[i], kernel.to_points(regions[i]))) return false;
+	}
+	return true;
+}
+
+//Erasers have to remove something, either another symbol or another eraser (taking both away).
+//Each symbol that gets erased has to be one that would otherwise break the region.
+bool Solver::check_region(const std::vector<Point>& items, const std::set<Point>& cells)
+{
+	std::vector<Point> others;
+	int erasers = 0;
+	for (Point p : items) {
+		if (p.first % 2 == 1 && p.second % 2 == 1 && (_grid[p.first][p.second] & 0xF00) == Decoration::Eraser) erasers++;
+		else others.push_back(p);
+	}
+	for (int amount = erasers; amount >= 0; amount -= 2) {
+		if (amount > static_cast<int>(others.size())) continue;
+		std::vector<int> erased(others.size(), 0);
+		std::fill(erased.end() - amount, erased.end(), 1);
+		do {
+			if (!region_valid(others, erased, cells)) continue;
+			bool needed = true;
+			for (size_t i = 0; i < erased.size() && needed; i++) {
+				if (!erased[i]) continue;
+				erased[i] = 0;
+				if (region_valid(others, erased, cells)) needed = false;
+				erased[i] = 1;
+			}
+			if (needed) return true;
+		} while (std::next_permutation(erased.begin(), erased.end()));
+	}
+	return false;
+}
+
+bool Solver::region_valid(const std::vector<Point>& items, const std::vector<int>& erased, const std::set<Point>& cells)
+{
+	std::vector<int> shapes, negativeShapes;
+	std::vector<int> colorCount(16, 0);
+	int stoneColor = 0;
+	for (size_t i = 0; i < items.size(); i++) {
+		if (erased[i]) continue;
+		int x = items[i].first, y = items[i].second;
+		if (x % 2 == 0 || y % 2 == 0) return false; //Missed dot
+		int symbol = _grid[x][y], type = symbol & 0xF00, color = symbol & 0xf;
+		colorCount[color]++;
+		if (type == Decoration::Stone) {
+			if (stoneColor && stoneColor != color) return false;
+			stoneColor = color;
+		}
+		if (type == Decoration::Triangle && count_path_edges(x, y) != (symbol & 0xf0000) >> 16) return false;
+		if (type == Decoration::Poly) {
+			if (symbol & Decoration::Negative) negativeShapes.push_back(symbol);
+			else shapes.push_back(symbol);
+		}
+	}
+	//Each star has to be paired with exactly one other symbol of its color
+	for (size_t i = 0; i < items.size(); i++) {
+		int symbol = _grid[items[i].first][items[i].second];
+		if (!erased[i] && (symbol & 0xF00) == Decoration::Star && colorCount[symbol & 0xf] != 2) return false;
+	}
+	if (shapes.size() || negativeShapes.size()) return fits_shapes(cells, shapes, negativeShapes);
+	return true;
+}
+
+bool Solver::fits_shapes(const std::set<Point>& cells, const std::vector<int>& shapes, const std::vector<int>& negativeShapes)
+{
+	int area = 0, negativeArea = 0;
+	for (int shape : shapes) area += static_cast<int>(get_shape(shape, 0).size());
+	for (int shape : negativeShapes) negativeArea += static_cast<int>(get_shape(shape, 0).size());
+	if (area == negativeArea) return true; //The shapes cancel out
+	if (area - negativeArea != static_cast<int>(cells.size())) return false;
+	std::vector<std::vector<int>> need(_width, std::vector<int>(_height, 0));
+	for (Point p : cells) need[p.first][p.second] = 1;
+	return place_negatives(need, shapes, negativeShapes, 0);
+}
+
+//Each negative shape adds to the area that the regular shapes have to cover. They can go anywhere on the grid.
+bool Solver::place_negatives(std::vector<std::vector<int>>& need, const std::vector<int>& shapes, const std::vector<int>& negativeShapes, size_t index)
+{
+	if (index == negativeShapes.size()) {
+		std::vector<bool> used(shapes.size(), false);
+		return tile(need, shapes, used);
+	}
+	int rotations = (negativeShapes[index] & Decoration::Can_Rotate) ? 4 : 1;
+	for (int r = 0; r < rotations; r++) {
+		std::vector<Offset> shape = get_shape(negativeShapes[index], r);
+		for (int x = 1; x < _width; x += 2) {
+			for (int y = 1; y < _height; y += 2) {
+				bool inside = true;
+				for (Offset o : shape) {
+					int sx = wrap(x + o.first), sy = y + o.second;
+					if (sx < 0 || sy < 0 || sx >= _width || sy >= _height) inside = false;
+				}
+				if (!inside) continue;
+				stamp(need, shape, x, y, 1);
+				bool found = place_negatives(need, shapes, negativeShapes, index + 1);
+				stamp(need, shape, x, y, -1);
+				if (found) return true;
+			}
+		}
+	}
+	return false;
+}
+
+//Cover the needed area exactly with the remaining shapes. The first uncovered point has to be covered by one of them.
+bool Solver::tile(std::vector<std::vector<int>>& need, const std::vector<int>& shapes, std::vector<bool>& used)
+{
+	int fx = -1, fy = -1;
+	for (int y = 1; y < _height && fx < 0; y += 2) {
+		for (int x = 1; x < _width; x += 2) {
+			if (need[x][y] > 0) {
+				fx = x; fy = y;
+				break;
+			}
+		}
+	}
+	if (fx < 0) return true;
+	std::set<int> tried;
+	for (size_t i = 0; i < shapes.size(); i++) {
+		if (used[i] || !tried.insert(shapes[i]).second) continue;
+		int rotations = (shapes[i] & Decoration::Can_Rotate) ? 4 : 1;
+		for (int r = 0; r < rotations; r++) {
+			std::vector<Offset> shape = get_shape(shapes[i], r);
+			for (Offset o : shape) {
+				int x = fx - o.first, y = fy - o.second;
+				if (!fits(need, shape, x, y)) continue;
+				stamp(need, shape, x, y, -1);
+				used[i] = true;
+				bool found = tile(need, shapes, used);
+				used[i] = false;
+				stamp(need, shape, x, y, 1);
+				if (found) return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool Solver::fits(const std::vector<std::vector<int>>& need, const std::vector<Offset>& shape, int x, int y) const
+{
+	for (Offset o : shape) {
+		int sx = wrap(x + o.first), sy = y + o.second;
+		if (sx < 0 || sy < 0 || sx >= _width || sy >= _height || need[sx][sy] <= 0) return false;
+	}
+	return true;
+}
+
+void Solver::stamp(std::vector<std::vector<int>>& need, const std::vector<Offset>& shape, int x, int y, int amount) const
+{
+	for (Offset o : shape) need[wrap(x + o.first)][y + o.second] += amount;
+}
+
+//Blocks of a shape symbol (see Generate::make_shape_symbol for the layout), as grid offsets
+std::vector<Solver::Offset> Solver::get_shape(int symbol, int rotation) const
+{
+	std::vector<Offset> shape;
+	for (int i = 0; i < 16; i++) {
+		if (!((symbol >> 16) & (1 << i))) continue;
+		int x = (i % 4) * 2, y = -(i / 4) * 2;
+		switch (rotation) {
+		case 0: shape.emplace_back(x, y); break;
+		case 1: shape.emplace_back(y, -x); break;
+		case 2: shape.emplace_back(-y, x); break;
+		case 3: shape.emplace_back(-x, -y); break;
+		}
+	}
+	return shape;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "GridTypes.h"
+#include "Bitboard.h"
+#include "SymbolChecker.h"
+#include "PathChecker.h"
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <stdint.h>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+//Statistics from the last call to Solver::solve
+struct SolverStats {
+	long long nodes; //Points the line was extended to
+	int solutions;
+	double milliseconds;
+	bool timedOut; //The search ran out of time, so there may be more solutions than were found
+	//For measuring difficulty (see Difficulty)
+	long long moves; //Moves that were searched, over all points
+	long long expandedNodes; //Points with at least one move that could be searched
+	long long forcedNodes; //Points with only one
+	long long deadEnds; //Lines that couldn't go any further without finishing
+	long long deadEndLength; //Total length of those lines
+	long long solutionLength; //Total length of the solutions
+};
+
+//Finds the solutions to a panel without the game, by tracing every possible line from the start points.
+//Moves are tracked in bitboards indexed by grid point, and partial lines are dropped as soon as they can no longer reach an exit or every dot,
+//or PathChecker finds a symbol they have already broken.
+//A finished line is checked against all of the symbols: the standard ones here, and the custom ones through SymbolChecker.
+//Doesn't touch the game's memory, so it can run anywhere. Point::pillarWidth must match the panel.
+class Solver {
+public:
+	//grid - same layout as Panel::_grid, starts/exits - points where the line can begin and end
+	//pillarWidth - width of the grid if the panel is a pillar, 0 otherwise
+	Solver(const std::vector<std::vector<int>>& grid, const std::set<Point>& starts, const std::set<Point>& exits, int pillarWidth);
+
+	//Makes the panel symmetric. symmetry[x][y] is the point that mirrors (x, y).
+	void set_symmetry(const std::vector<std::vector<Point>>& symmetry);
+	//Search for solutions, stopping once maxSolutions have been found (0 to find them all). Returns the number found.
+	int solve(int maxSolutions);
+	//Count solutions without keeping them, stopping at limit or after timeBudget milliseconds (0 for no time limit).
+	//To check that a puzzle has at most K solutions, use a limit of K + 1.
+	int count_solutions(int limit, double timeBudget);
+	//Check a single finished line (and its symmetric line, if any) against the symbols
+	bool check_path(const std::vector<Point>& path);
+
+	const std::vector<std::vector<Point>>& get_solutions() const { return _solutions; }
+	const SolverStats& get_stats() const { return _stats; }
+
+private:
+	typedef std::pair<int, int> Offset; //Not a Point, since Point wraps around pillars
+
+	void begin(int maxSolutions, double timeBudget, bool keepSolutions);
+	void run(int maxSolutions, double timeBudget, bool keepSolutions);
+	void split(size_t depth, int maxSolutions, double timeBudget);
+	void search_from(const std::vector<Point>& prefix);
+	void search(Point pos, Point symPos);
+	int search_moves(Point pos);
+	int total_solutions() const { return _sharedSolutions ? _sharedSolutions->load(std::memory_order_relaxed) : _stats.solutions; }
+	bool stopped() const { return _stats.timedOut || (_maxSolutions && total_solutions() >= _maxSolutions); }
+	bool move(Point pos, int dir, Point& next) const;
+	bool is_free(Point pos) const;
+	void visit(Point pos, bool sym);
+	void unvisit(Point pos, bool sym);
+	Bitboard reach(Point from) const;
+	bool can_finish(Point pos, Point symPos) const;
+	bool closes_region(Point pos) const;
+	int count_path_edges(int x, int y) const;
+	bool validate();
+	bool check_region(const std::vector<Point>& items, const std::set<Point>& cells);
+	bool region_valid(const std::vector<Point>& items, const std::vector<int>& erased, const std::set<Point>& cells);
+	bool fits_shapes(const std::set<Point>& cells, const std::vector<int>& shapes, const std::vector<int>& negativeShapes);
+	bool place_negatives(std::vector<std::vector<int>>& need, const std::vector<int>& shapes, const std::vector<int>& negativeShapes, size_t index);
+	bool tile(std::vector<std::vector<int>>& need, const std::vector<int>& shapes, std::vector<bool>& used);
+	bool fits(const std::vector<std::vector<int>>& need, const std::vector<Offset>& shape, int x, int y) const;
+	void stamp(std::vector<std::vector<int>>& need, const std::vector<Offset>& shape, int x, int y, int amount) const;
+	std::vector<Offset> get_shape(int symbol, int rotation) const;
+	int wrap(int x) const { return _pillarWidth ? (x + _width) % _width : x; }
+
+	std::vector<std::vector<int>> _grid;
+	int _width, _height, _pillarWidth;
+	std::vector<Point> _starts;
+	Bitboard _exits;
+	Bitboard _passable; //Points the line is allowed to go through
+	Bitboard _dots;
+	Bitboard _visited, _symVisited; //Points covered by either line, and by the symmetric line only
+	std::vector<std::vector<Point>> _symmetry; //Empty if the panel isn't symmetric
+	std::vector<Point> _path, _symPath;
+	bool _hasErasers, _hasCustomSymbols, _hasColoredDots;
+	bool _tooBig; //Wider or taller than a Bitboard, so it can't be searched
+	int _maxSolutions;
+	bool _keepSolutions;
+	std::chrono::steady_clock::time_point _deadline;
+	bool _hasDeadline;
+	//Hash of the visited points (Zobrist hashing, so it can be updated one point at a time), and the states already known to have no solutions
+	uint64_t _hash;
+	uint64_t _zobrist[2][Bitboard::SIZE][Bitboard::SIZE], _zobristHead[Bitboard::SIZE][Bitboard::SIZE];
+	std::unordered_set<uint64_t> _deadStates;
+	//For splitting the search into subtrees: lines are cut off once they reach _splitDepth points and saved in _tasks
+	size_t _splitDepth;
+	std::vector<std::vector<Point>> _tasks;
+	std::atomic<int>* _sharedSolutions; //Solution count shared with other threads working on the same panel, if any
+	std::vector<std::vector<Point>> _solutions;
+	SolverStats _stats;
+	SymbolChecker _checker;
+	PathChecker _pathChecker;
+
+	static const int _DIRECTIONS[4][2];
+	static const size_t _MAX_DEAD_STATES = 1 << 20;
+
+	friend class ParallelSolver;
+};
@@ -4,7 +4,9 @@
 
 #include "Special.h"
 #include "MultiGenerate.h"
+#include "PivotGenerate.h"
 #include "Quaternion.h"
+#include "Solver.h"
 #include "../App/Version.h"
 
 void Special::generateSymmetryDespair(int id, Panel::Symmetry sym) {
@@ -53,11 +55,34 @@ void Special::generateSpecialSymMaze(std::shared_ptr<Generate> gen, int id) {
 }
 
 void Special::generateReflectionDotPuzzle(std::shared_ptr<Generate> gen, int id1, int id2, std::vector<std::pair<int, int>> symbols, Panel::Symmetry symmetry, bool split)
+{
+	std::shared_ptr<Panel> puzzle, flippedPuzzle;
+	std::chrono::steady_clock::time_point deadline = gen->get_deadline();
+	while (!generateReflectionDotPuzzle(gen, id1, id2, symbols, symmetry, split, puzzle, flippedPuzzle)) {
+		if (gen->_progress) gen->_progress->checkCancelled();
+		if (std::chrono::steady_clock::now() < deadline) continue;
+		gen->log_fallback(id1, L"out of time, keeping the game's reflection puzzles");
+		gen->incrementProgress();
+		gen->_skipped.insert(id1);
+		gen->_skipped.insert(id2);
+		return;
+	}
+	if (split) {
+		Color color = flippedPuzzle->_memory->ReadPanelData<Color>(id2, SUCCESS_COLOR_A);
+		flippedPuzzle->_memory->WritePanelData<Color>(id2, PATTERN_POINT_COLOR, { color });
+	}
+	gen->write(id1);
+	flippedPuzzle->Write(id2);
+}
+
+//Make one attempt at the reflection pair. Fails if the split dots could also be solved with another symmetry.
+bool Special::generateReflectionDotPuzzle(std::shared_ptr<Generate> gen, int id1, int id2, const std::vector<std::pair<int, int>>& symbols, Panel::Symmetry symmetry, bool split,
+	std::shared_ptr<Panel>& puzzle, std::shared_ptr<Panel>& flippedPuzzle)
 {
 	gen->setFlagOnce(Generate::Config::DisableWrite);
 	gen->generate(id1, symbols);
-	std::shared_ptr<Panel> puzzle = gen->_panel;
-	std::shared_ptr<Panel> flippedPuzzle = std::make_shared<Panel>(id2);
+	puzzle = gen->_panel;
+	flippedPuzzle = std::make_shared<Panel>(id2);
 	std::vector<Point> dots;
 	for (int x = 0; x < puzzle->_width; x++) {
 		for (int y = 0; y < puzzle->_height; y++) {
@@ -87,8 +112,6 @@ void Special::generateReflectionDotPuzzle(std::shared_ptr<Generate> gen, int id1
 			Point sp = puzzle->get_sym_point(dot.first, dot.second, symmetry);
 			flippedPuzzle->_grid[sp.first][sp.second] &= ~IntersectionFlags::DOT_IS_INVISIBLE;
 		}
-		Color color = flippedPuzzle->_memory->ReadPanelData<Color>(id2, SUCCESS_COLOR_A);
-		flippedPuzzle->_memory->WritePanelData<Color>(id2, PATTERN_POINT_COLOR, { color });
 	}
 	flippedPuzzle->_startpoints.clear();
 	for (Point p : puzzle->_startpoints) {
@@ -100,14 +123,7 @@ void Special::generateReflectionDotPuzzle(std::shared_ptr<Generate> gen, int id1
 		flippedPuzzle->_endpoints.push_back(Endpoint(sp.first, sp.second, gen->_panel->get_sym_dir(p.GetDir(), symmetry),
 			IntersectionFlags::ENDPOINT | (p.GetDir() == Endpoint::Direction::UP || p.GetDir() == Endpoint::Direction::DOWN ? IntersectionFlags::COLUMN : IntersectionFlags::ROW)));
 	}
-	if (id1 == 0x00A5B && split) {
-		if (checkDotSolvability(puzzle, flippedPuzzle, symmetry)) {
-			generateReflectionDotPuzzle(gen, id1, id2, symbols, symmetry, split);
-			return;
-		}
-	}
-	gen->write(id1);
-	flippedPuzzle->Write(id2);
+	return !split || !checkSymmetryAmbiguity(puzzle, flippedPuzzle, symmetry);
 }
 
 void Special::generateAntiPuzzle(int id)
@@ -819,7 +835,15 @@ void Special::generate2Bridge(int id1, int id2)
 		g->setFlag(Generate::Config::ShortPath);
 		g->setFlag(Generate::Config::WriteColors);
 	}
-	while (!generate2Bridge(id1, id2, gens));
+	std::chrono::steady_clock::time_point deadline = generator->get_deadline();
+	while (!generate2Bridge(id1, id2, gens)) {
+		if (std::chrono::steady_clock::now() < deadline) continue;
+		generator->log_fallback(id1, L"out of time, keeping the game's bridge puzzles");
+		generator->incrementProgress();
+		generator->_skipped.insert(id1);
+		generator->_skipped.insert(id2);
+		return;
+	}
 	gens[1]->write(id1);
 	gens[1]->write(id2);
 	generator->incrementProgress();
@@ -900,7 +924,15 @@ void Special::generate2BridgeH(int id1, int id2)
 		g->setFlag(Generate::Config::ShortPath);
 		g->setFlag(Generate::Config::WriteColors);
 	}
-	while (!generate2BridgeH(id1, id2, gens));
+	std::chrono::steady_clock::time_point deadline = generator->get_deadline();
+	while (!generate2BridgeH(id1, id2, gens)) {
+		if (std::chrono::steady_clock::now() < deadline) continue;
+		generator->log_fallback(id1, L"out of time, keeping the game's bridge puzzles");
+		generator->incrementProgress();
+		generator->_skipped.insert(id1);
+		generator->_skipped.insert(id2);
+		return;
+	}
 	
 	
 	gens[0]->write(id1);
@@ -1234,26 +1266,35 @@ void Special::generateMountainFloorH()
 
 void Special::generatePivotPanel(int id, Point gridSize, const std::vector<std::pair<int, int>>& symbolVec, bool colorblind) {
 	int width = gridSize.first * 2 + 1, height = gridSize.second * 2 + 1;
-	std::vector<std::shared_ptr<Generate>> gens;
-	for (int i = 0; i < 3; i++) gens.push_back(std::make_shared<Generate>());
-	for (std::shared_ptr<Generate> gen : gens) {
-		gen->seed(Random::rand());
-		gen->colorblind = colorblind;
-		gen->setSymbol(Decoration::Start, width / 2, height - 1);
-		gen->setGridSize(gridSize.first, gridSize.second);
-		gen->setFlag(Generate::Config::FixBackground);
-		gen->setFlag(Generate::Config::DisableWrite);
-	}
-	gens[0]->setSymbol(Decoration::Exit, 0, height / 2);
-	gens[1]->setSymbol(Decoration::Exit, width - 1, height / 2);
-	gens[2]->setSymbol(Decoration::Exit, width / 2, 0);
-	generator->generateMulti(id, gens, symbolVec);
-	gens[0]->_panel->_endpoints.clear();
-	gens[0]->_panel->SetGridSymbol(0, height / 2, Decoration::Exit, Decoration::Color::None);
-	gens[0]->_panel->SetGridSymbol(width - 1, height / 2, Decoration::Exit, Decoration::Color::None);
-	gens[0]->_panel->SetGridSymbol(width / 2, 0, Decoration::Exit, Decoration::Color::None);
-	gens[0]->setFlag(Generate::Config::TreehouseColors);
-	gens[0]->write(id);
+	PivotGenerate pivot(width, height);
+	//PivotGenerate can't make panels bigger than a bitboard, so those are skipped right away instead of running out the clock
+	bool fits = width <= Bitboard::SIZE && height <= Bitboard::SIZE;
+	std::chrono::steady_clock::time_point deadline = generator->get_deadline();
+	while (!fits || !pivot.generate(symbolVec)) {
+		if (generator->_progress) generator->_progress->checkCancelled();
+		if (fits && std::chrono::steady_clock::now() < deadline) continue;
+		generator->log_fallback(id, fits ? L"out of time, keeping the game's pivot puzzle" : L"too big for PivotGenerate, keeping the game's pivot puzzle");
+		generator->incrementProgress();
+		generator->_skipped.insert(id);
+		return;
+	}
+	std::shared_ptr<Generate> gen = std::make_shared<Generate>();
+	gen->colorblind = colorblind;
+	gen->setSymbol(Decoration::Start, pivot.get_start().first, pivot.get_start().second);
+	gen->setGridSize(gridSize.first, gridSize.second);
+	gen->setFlag(Generate::Config::FixBackground);
+	gen->setFlag(Generate::Config::TreehouseColors);
+	gen->initPanel(id);
+	gen->clear();
+	for (int x = 1; x < width; x += 2) {
+		for (int y = 1; y < height; y += 2) {
+			if (pivot.get_grid()[x][y]) gen->set(x, y, pivot.get_grid()[x][y]);
+		}
+	}
+	gen->_panel->_endpoints.clear();
+	for (Point exit : pivot.get_exits()) gen->_panel->SetGridSymbol(exit.first, exit.second, Decoration::Exit, Decoration::Color::None);
+	gen->write(id);
+	generator->incrementProgress();
 	int style = ReadPanelData<int>(id, STYLE_FLAGS);
 	WritePanelData(id, STYLE_FLAGS, { style | Panel::Style::IS_PIVOTABLE });
 }
@@ -1401,51 +1442,61 @@ void Special::generateSymmetryGate(int id)
 	WriteArray(id, REFLECTION_DATA, symData);
 }
 
-bool Special::checkDotSolvability(std::shared_ptr<Panel> panel1, std::shared_ptr<Panel> panel2, Panel::Symmetry correctSym) {
-	std::vector<Panel::Symmetry> sym = { Panel::Symmetry::FlipXY, Panel::Symmetry::FlipNegXY, Panel::Symmetry::RotateLeft, Panel::Symmetry::RotateRight };
+//The grid as the player sees it, without the intended path or any hidden dots
+static std::vector<std::vector<int>> get_visible_grid(std::vector<std::vector<int>> grid) {
+	for (auto& column : grid) {
+		for (int& value : column) {
+			if (value == PATH || ((value & DOT) && (value & DOT_IS_INVISIBLE))) value = 0;
+		}
+	}
+	return grid;
+}
+
+//Check whether the dots could also be solved with a symmetry other than correctSym, in which case the player can't tell which symmetry is meant.
+//If panel2 is given, the two panels are a reflection pair: the line is traced on panel1 and shows up mirrored on panel2. Otherwise panel1 is a symmetry panel.
+//All the symmetries share one time budget. If it runs out before every other symmetry is ruled out, the panel counts as ambiguous.
+bool Special::checkSymmetryAmbiguity(std::shared_ptr<Panel> panel1, std::shared_ptr<Panel> panel2, Panel::Symmetry correctSym) {
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(static_cast<long long>(_AMBIGUITY_TIME_BUDGET));
+	auto solvable = [&](Solver& solver) {
+		double timeBudget = std::chrono::duration<double, std::milli>(deadline - std::chrono::steady_clock::now()).count();
+		if (timeBudget <= 0) return true;
+		return solver.count_solutions(1, timeBudget) > 0 || solver.get_stats().timedOut;
+	};
+	std::vector<Panel::Symmetry> sym = { Panel::Symmetry::Horizontal, Panel::Symmetry::Vertical, Panel::Symmetry::Rotational };
+	if (panel1->_width == panel1->_height)
+		sym.insert(sym.end(), { Panel::Symmetry::RotateLeft, Panel::Symmetry::RotateRight, Panel::Symmetry::FlipXY, Panel::Symmetry::FlipNegXY });
+	std::vector<std::vector<int>> grid1 = get_visible_grid(panel1->_grid);
+	std::set<Point> starts(panel1->_startpoints.begin(), panel1->_startpoints.end()), exits;
+	for (Endpoint e : panel1->_endpoints) exits.insert(Point(e.GetX(), e.GetY()));
 	for (Panel::Symmetry s : sym) {
 		if (s == correctSym) continue;
-		bool found = false;
-		//Check for three dots at a point
-		for (int x = 0; x < panel1->_width; x += 2) {
-			for (int y = 0; y < panel1->_height; y += 2) {
-				int count = 0;
-				for (Point dir : Generate::_DIRECTIONS1) {
-					Point p = { x + dir.first, y + dir.second };
-					Point sp = panel1->get_sym_point(p, s);
-					if (p.first < 0 || p.second < 0 || p.first >= panel1->_width || p.second >= panel1->_height) continue;
-					if (((panel1->_grid[p.first][p.second] & Decoration::Dot) && !(panel1->_grid[p.first][p.second] & IntersectionFlags::DOT_IS_INVISIBLE)) ||
-						((panel2->_grid[sp.first][sp.second] & Decoration::Dot) && !(panel2->_grid[sp.first][sp.second] & IntersectionFlags::DOT_IS_INVISIBLE))) {
-						if (++count == 3) {
-							found = true;
-							break;
-						}
-					}
-				}
-				if (found) break;
-			}
-			if (found) break;
-		}
-		//Check for four dots in a circle
-		for (int x = 1; x < panel1->_width; x += 2) {
-			for (int y = 1; y < panel1->_height; y += 2) {
-				int count = 0;
-				for (Point dir : Generate::_DIRECTIONS1) {
-					Point p = { x + dir.first, y + dir.second };
-					Point sp = panel1->get_sym_point(p, s);
-					if (((panel1->_grid[p.first][p.second] & Decoration::Dot) && !(panel1->_grid[p.first][p.second] & IntersectionFlags::DOT_IS_INVISIBLE)) ||
-						((panel2->_grid[sp.first][sp.second] & Decoration::Dot) && !(panel2->_grid[sp.first][sp.second] & IntersectionFlags::DOT_IS_INVISIBLE))) {
-						if (++count == 4) {
-							found = true;
-							break;
-						}
-					}
-				}
-				if (found) break;
+		std::vector<std::vector<Point>> symPoints(panel1->_width, std::vector<Point>(panel1->_height));
+		for (int x = 0; x < panel1->_width; x++) {
+			for (int y = 0; y < panel1->_height; y++) symPoints[x][y] = panel1->get_sym_point(x, y, s);
+		}
+		if (!panel2) {
+			Solver solver(grid1, starts, exits, 0);
+			solver.set_symmetry(symPoints);
+			if (solvable(solver)) return true;
+			continue;
+		}
+		//Bring everything on panel2 back onto panel1 the way the line would be mirrored under this symmetry
+		std::vector<std::vector<int>> grid = grid1, grid2 = get_visible_grid(panel2->_grid);
+		std::set<Point> starts2(panel2->_startpoints.begin(), panel2->_startpoints.end()), exits2, symStarts, symExits;
+		for (Endpoint e : panel2->_endpoints) exits2.insert(Point(e.GetX(), e.GetY()));
+		for (int x = 0; x < panel1->_width; x++) {
+			for (int y = 0; y < panel1->_height; y++) {
+				Point sp = symPoints[x][y];
+				int value = grid2[sp.first][sp.second];
+				if (value == OPEN || (value & GAP)) grid[x][y] = value;
+				else if (value & DOT) grid[x][y] |= DOT;
 			}
-			if (found) break;
 		}
-		if (!found) return true;
+		for (Point p : starts) if (starts2.count(symPoints[p.first][p.second])) symStarts.insert(p);
+		for (Point p : exits) if (exits2.count(symPoints[p.first][p.second])) symExits.insert(p);
+		if (symStarts.empty() || symExits.empty()) continue;
+		Solver solver(grid, symStarts, symExits, 0);
+		if (solvable(solver)) return true;
 	}
 	return false;
 }
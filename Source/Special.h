@@ -27,6 +27,8 @@ public:
 	void generateSymmetryDespair(int id, Panel::Symmetry sym);
 	void generateSpecialSymMaze(std::shared_ptr<Generate> gen, int id);
 	void generateReflectionDotPuzzle(std::shared_ptr<Generate> gen, int id1, int id2, std::vector<std::pair<int, int>> symbols, Panel::Symmetry symmetry, bool split);
+	bool generateReflectionDotPuzzle(std::shared_ptr<Generate> gen, int id1, int id2, const std::vector<std::pair<int, int>>& symbols, Panel::Symmetry symmetry, bool split,
+		std::shared_ptr<Panel>& puzzle, std::shared_ptr<Panel>& flippedPuzzle);
 	void generateAntiPuzzle(int id);
 	void generateColorFilterPuzzle(int id, Point size, const std::vector<std::pair<int, int>>& symbols, const Color& filter);
 	void generateSoundDotPuzzle(int id, Point size, std::vector<int> dotSequence, bool writeSequence);
@@ -49,14 +51,14 @@ public:
 	bool generate2BridgeH(int id1, int id2, std::vector<std::shared_ptr<Generate>> gens);
 	void generateMountainFloor();
 	void generateMountainFloorH();
-	void generatePivotPanel(int id, Point gridSize, const std::vector<std::pair<int, int>>& symbolVec, bool colorblind); //Too slow right now, only used a couple times in hard mode
+	void generatePivotPanel(int id, Point gridSize, const std::vector<std::pair<int, int>>& symbolVec, bool colorblind); //Symbols have to work for all three exits (see PivotGenerate)
 	void modifyGate(int id);
 	void addDecoyExits(std::shared_ptr<Generate> gen, int amount);
 	void initSSGrid(std::shared_ptr<Generate> gen);
 	void initRotateGrid(std::shared_ptr<Generate> gen);
 	void initPillarSymmetry(std::shared_ptr<Generate> gen, int id, Panel::Symmetry symmetry);
 	void generateSymmetryGate(int id);
-	bool checkDotSolvability(std::shared_ptr<Panel> panel1, std::shared_ptr<Panel> panel2, Panel::Symmetry correctSym);
+	bool checkSymmetryAmbiguity(std::shared_ptr<Panel> panel1, std::shared_ptr<Panel> panel2, Panel::Symmetry correctSym);
 	void createArrowPuzzle(int id, int x, int y, int dir, int ticks, const std::vector<Point>& gaps);
 	void createArrowSecretDoor(int id);
 	void generateCenterPerspective(int id, const std::vector<std::pair<int, int>>& symbolVec, int symbolType);
@@ -202,6 +204,8 @@ private:
 
 	std::shared_ptr<Generate> generator;
 
+	static constexpr double _AMBIGUITY_TIME_BUDGET = 300; //Milliseconds the solver gets to rule out every other symmetry in checkSymmetryAmbiguity
+
 	template <class T> T pick_random(std::vector<T>& vec) { return vec[Random::rand() % vec.size()]; }
 	template <class T> T pick_random(std::set<T>& set) { auto it = set.begin(); std::advance(it, Random::rand() % set.size()); return *it; }
 	template <class T> T pop_random(std::vector<T>& vec) {
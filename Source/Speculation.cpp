@@ -0,0 +1,106 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "Speculation.h"
+#include "Panel.h"
+#include "Watchdog.h"
+
+Speculation::Speculation(const Options& options)
+{
+	_options = options;
+	_adopted = false;
+	_randomizer = std::make_shared<Randomizer>();
+	_randomizer->seed = options.seed;
+	_randomizer->seedIsRNG = false;
+	_randomizer->colorblind = options.colorblind;
+	_randomizer->doubleMode = options.doubleMode;
+	_progress = std::make_shared<Progress>();
+	{
+		std::lock_guard<std::mutex> lock(_retiredMutex);
+		_previous.swap(_retired);
+	}
+	_progress->run([this]() { run(); });
+}
+
+Speculation::~Speculation()
+{
+	cancel();
+	_progress->join();
+}
+
+void Speculation::cancel()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	if (!_adopted) _progress->cancel();
+	lock.unlock();
+	_changed.notify_all();
+}
+
+void Speculation::retire(std::shared_ptr<Speculation> speculation)
+{
+	speculation->cancel();
+	std::lock_guard<std::mutex> lock(_retiredMutex);
+	_retired.push_back(speculation);
+}
+
+void Speculation::waitForRetired()
+{
+	std::vector<std::shared_ptr<Speculation>> retired;
+	std::unique_lock<std::mutex> lock(_retiredMutex);
+	retired.swap(_retired);
+	lock.unlock();
+	retired.clear(); //Joins each one's thread
+}
+
+std::vector<std::shared_ptr<Speculation>> Speculation::_retired;
+std::mutex Speculation::_retiredMutex;
+
+void Speculation::adopt(std::function<void()> finish)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_finish = finish;
+	_adopted = true;
+	lock.unlock();
+	_changed.notify_all();
+}
+
+void Speculation::run()
+{
+	_previous.clear(); //Joins them, so they are done taking their panels out of the lists below
+	size_t numPanels, numCustom;
+	{
+		std::lock_guard<std::mutex> lock(Panel::registryMutex);
+		numPanels = Panel::generatedPanels.size();
+		numCustom = Panel::customSymbolPuzzles.size();
+	}
+	WriteQueue writes;
+	std::vector<Watchdog*> watchdogs;
+	Memory::writeQueue = &writes;
+	Watchdog::heldBack = &watchdogs;
+	try {
+		_randomizer->GeneratePuzzles(_options.hard, NULL, _progress);
+		_progress->setArea(L"Ready", 0);
+		std::unique_lock<std::mutex> lock(_mutex);
+		_changed.wait(lock, [&] { return _adopted || _progress->isCancelled(); });
+		lock.unlock();
+		_progress->checkCancelled();
+	}
+	catch (...) {
+		//Nothing reached the game, so forget the panels and watchdogs that were made for it
+		Memory::writeQueue = nullptr;
+		Watchdog::heldBack = nullptr;
+		for (Watchdog* watchdog : watchdogs) delete watchdog;
+		std::lock_guard<std::mutex> lock(Panel::registryMutex);
+		Panel::generatedPanels.erase(Panel::generatedPanels.begin() + numPanels, Panel::generatedPanels.end());
+		Panel::customSymbolPuzzles.erase(Panel::customSymbolPuzzles.begin() + numCustom, Panel::customSymbolPuzzles.end());
+		throw;
+	}
+	Memory::writeQueue = nullptr;
+	Watchdog::heldBack = nullptr;
+	_progress->setArea(L"Writing puzzles...", 0);
+	_randomizer->_memory->Flush(writes);
+	for (Watchdog* watchdog : watchdogs) watchdog->start();
+	_randomizer->Finish(NULL, _progress);
+	_finish();
+}
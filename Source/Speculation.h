@@ -0,0 +1,55 @@
+#pragma once
+#include "Randomizer.h"
+#include "Progress.h"
+#include "Memory.h"
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//Generates the puzzles for the options picked in the window before Randomize is clicked, on a thread of its own.
+//Every game write it makes is held back (see WriteQueue) and the watchdogs it makes aren't started, so the game doesn't change until it is adopted.
+//Once the puzzles are made it waits. If Randomize is clicked with the same options, it is adopted: the held back writes go to the game
+//(after the rest of the puzzles are made, if it isn't that far yet) and the randomization is finished on the same thread.
+//If the options change instead, retire it: it is cancelled and takes back everything it did on its own thread, and whatever generates next waits for that first.
+class Speculation {
+public:
+	struct Options {
+		int seed;
+		bool hard, colorblind, doubleMode;
+		bool operator==(const Options& other) const {
+			return seed == other.seed && hard == other.hard && colorblind == other.colorblind && doubleMode == other.doubleMode;
+		}
+	};
+
+	Speculation(const Options& options); //Starts generating right away
+	~Speculation(); //If it wasn't adopted, cancels it and waits for the thread to clean up. Otherwise waits for the randomization to finish.
+
+	//Cancel the speculation without waiting for it, and keep it until waitForRetired, so that it isn't destroyed (and waited for) on the window's thread
+	static void retire(std::shared_ptr<Speculation> speculation);
+	//Wait for the retired speculations to take back what they did. Call before generating anything else, on the thread that will generate it.
+	static void waitForRetired();
+
+	//Write the puzzles to the game, then start the watchdogs and call finish, all on the speculation's thread. The progress shows how it is going.
+	void adopt(std::function<void()> finish);
+
+	const Options& getOptions() const { return _options; }
+	std::shared_ptr<Progress> getProgress() { return _progress; }
+
+private:
+	void cancel();
+	void run();
+
+	Options _options;
+	std::shared_ptr<Randomizer> _randomizer;
+	std::shared_ptr<Progress> _progress;
+	std::function<void()> _finish;
+	bool _adopted;
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::vector<std::shared_ptr<Speculation>> _previous; //Retired before this one started. Its thread waits for them, since they are taking their panels back.
+
+	static std::vector<std::shared_ptr<Speculation>> _retired;
+	static std::mutex _retiredMutex;
+};
@@ -0,0 +1,448 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "SymbolChecker.h"
+#include "BarPatterns.h"
+#include <climits>
+
+SymbolChecker::SymbolChecker()
+{
+	width = height = pillarWidth = 0;
+	DIRECTIONS = { Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0), Point(2, 2), Point(2, -2), Point(-2, -2), Point(-2, 2) };
+}
+
+void SymbolChecker::set_grid(const std::vector<std::vector<int>>& grid)
+{
+	this->grid = grid;
+	width = static_cast<int>(grid.size());
+	height = static_cast<int>(grid[0].size());
+}
+
+//Check every symbol against the path currently marked in the grid
+bool SymbolChecker::check_all()
+{
+	regions = std::make_shared<RegionKernel>(grid, Point(1, 1), pillarWidth > 0, false);
+	regions->label_regions();
+	for (int x = 1; x < width; x++) {
+		for (int y = 1; y < height; y++) {
+			if (!check(x, y)) return false;
+		}
+	}
+	return true;
+}
+
+bool SymbolChecker::check(int x, int y)
+{
+	int symbol = grid[x][y];
+	int type = symbol & 0xF000700;
+	if (type == Decoration::Arrow) {
+		return checkArrow(x, y, symbol);
+	}
+	if (type == Decoration::Mine) {
+		return checkMine(x, y, symbol);
+	}
+	if (type == Decoration::Head) {
+		return checkHead(x, y, symbol);
+	}
+	if (type == Decoration::Mushroom) {
+		return checkMushroom(x, y);
+	}
+	if (type == Decoration::Ghost) {
+		return checkGhost();
+	}
+	if (type == Decoration::Bar) {
+		return checkBar(x, y, symbol);
+	}
+	if (type == Decoration::Antitriangle) {
+		return checkAntitriangle(x, y, symbol);
+	}
+	if (type == Decoration::Dart) {
+		return checkDart(x, y, symbol);
+	}
+	if (type == Decoration::Rain) {
+		return checkRain(x, y, symbol);
+	}
+	if (type == Decoration::Pointer) {
+		return checkPointer(x, y, symbol);
+	}
+	if (type == Decoration::Diamond) {
+		return checkDiamond(x, y, symbol);
+	}
+	if (type == Decoration::Dice) {
+		return checkDice(x, y);
+	}
+	if (type == Decoration::Bell) {
+		return checkBell(x, y, symbol);
+	}
+	if (type == Decoration::Tent) {
+		return checkTent(x, y);
+	}
+	if (type == Decoration::Circle) {
+		return checkCircle(x, y);
+	}
+	if (type == Decoration::NewSymbolsF) {
+		return checkNewSymbolsF();
+	}
+	return true;
+}
+
+bool SymbolChecker::checkArrow(int x, int y, int symbol)
+{
+	if (pillarWidth > 0) return checkArrowPillar(x, y);
+	int targetCount = (symbol & 0xf000) >> 12;
+	Point dir = DIRECTIONS[(symbol & 0xf0000) >> 16];
+	x += dir.first / 2; y += dir.second / 2;
+	int count = 0;
+	while (x >= 0 && x < width && y >= 0 && y < height) {
+		if (grid[x][y] == PATH) {
+			if (++count > targetCount)
+				return false;
+		}
+		x += dir.first; y += dir.second;
+	}
+	return count == targetCount;
+}
+
+bool SymbolChecker::checkMine(int x, int y,int symbol) {
+	return regions->get_neighbor_count(Point(x, y)) == (0xf0000 & symbol) >> 16;
+}
+
+bool SymbolChecker::checkHead(int x, int y, int symbol) {
+	if ((symbol & 0xf0000) >> 16 == 9) return true;
+	std::vector<Point> _8dir = { Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0), Point(2, 2), Point(2, -2), Point(-2, -2), Point(-2, 2) };
+	Point dir = _8dir[(symbol & 0xf0000) >> 16];
+	for (Point p : get_region(Point(x, y))) {
+		if (((dir.first == 0 || (p.first - x) * dir.first >  0) && (dir.second == 0 || (p.second - y) * dir.second > 0))) {
+			if (!(grid[p.first][p.second] == 0x2090000 || grid[p.first][p.second]  == 0x600 || grid[p.first][p.second] == 0x0 || grid[p.first][p.second] == 0xA00)) return false;
+		}
+	}
+	return true;
+}
+
+bool SymbolChecker::checkMushroom(int x, int y) {
+	std::vector<Point> DIRECTIONS = { Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0) };
+	for (Point dir : DIRECTIONS) {
+		int local_x = x + dir.first / 2;
+		int local_y = y + dir.second / 2;
+		bool flag = false;
+		while ((local_x >= 0 && local_x < width && local_y >= 0 && local_y < height) && !flag) {
+			if (grid[local_x][local_y] == PATH) flag = true;
+			local_x += dir.first; local_y += dir.second;
+		}
+		if (!flag) return false;
+	}
+	
+	return true;
+}
+
+bool SymbolChecker::checkGhost() {
+	//Every region needs exactly one ghost
+	std::vector<int> ghosts(regions->get_regions().size(), 0);
+	for (int x = 1; x < width; x += 2) {
+		for (int y = 1; y < height; y += 2) {
+			int label = regions->get_label(Point(x, y));
+			if (label >= 0 && (get(Point(x, y)) & 0xf000000) == Decoration::Ghost) ghosts[label]++;
+		}
+	}
+	for (int count : ghosts) {
+		if (count != 1) return false;
+	}
+	return true;
+}
+
+bool SymbolChecker::checkBar(int x, int y, int symbol) {
+	int num = (symbol & 0xF0000) >> 16;
+	Point pos = Point(x,y);
+	//0:X(null) 1:(OOCC) 2:(COOC) 3:(CCOO) 4:(OCCO) 5:(COOO) 6:(OCOO) 7:(OOCO) 8:(OOOC) 9:(OOOO) A:(OCOC) B:(COCO) C:Gap_Column D:Gap_Row
+	std::shared_ptr<RegionKernel> kernel = get_kernel(pos);
+	Bitboard region = get_region_cells(*kernel, pos);
+	std::vector<int> region_data = BarPatterns::histogram(grid, *kernel, region);
+	for (Point p : kernel->to_points(region)) {
+		if ((grid[p.first][p.second] & 0xF0F0000) == (symbol & 0xF0F0000)) {
+			region_data[(grid[p.first][p.second] & 0xF0000) >> 16] -= 1;
+		}
+	}
+	return region_data[num] == 0;
+}
+
+bool SymbolChecker::checkAntitriangle(int x, int y, int symbol) {
+	int num = 0;
+	for (Point c : {Point(1, 1), Point(1, -1), Point(-1, -1), Point(-1, 1)}) {
+		if (check_it_is_corner(Point(x + c.first,y + c.second))) {
+			num += 1;
+		}
+	}
+
+	return num == (symbol & 0xf0000) >> 16;
+}
+
+int SymbolChecker::get(Point p) { return grid[p.first][p.second]; }
+
+bool SymbolChecker::check_it_is_corner(Point pos) {
+	std::vector<bool> _4dir = { false,false,false,false };
+	int i = 0;
+	for (Point c : {Point(0, -1), Point(1, 0), Point(0, 1), Point(-1, 0)}) {
+		if ((pos + c).first < 0 || (pos + c).second < 0 || (pos + c).first >= width || (pos + c).second >= height)
+		{
+			_4dir[i] = false;
+		}
+		else if (get(pos + c) == PATH) {
+			_4dir[i] = true;
+		}
+		i++;
+	}
+
+	std::vector<std::vector<bool>> data = {
+		{ true, true, false, false },
+		{ false, true, true, false },
+		{ false, false, true, true },
+		{ true, false, false, true },
+		{ false, true, true, true },
+		{ true, false, true, true },
+		{ true, true, false, true },
+		{ true, true, true, false },
+		{ true, true, true, true },
+	};
+
+	for (std::vector<bool> d : data) {
+		if (_4dir == d)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//
+bool SymbolChecker::checkDart(int x, int y, int symbol) {
+	int targetCount = (symbol & 0xf0000) >> 16;//the number
+	Point dir = DIRECTIONS[(symbol & 0xf000) >> 12];//the direction
+	int count = 0;
+	std::set<Point> pointset = get_region(Point(x, y));
+	while (x >= 0 && x < width && y >= 0 && y < height) {
+		x += dir.first; y += dir.second;
+		for (Point p : pointset) {
+			if (p == Point(x, y)) {
+				count += 1;
+			}
+		}
+	}
+
+	return count == targetCount;
+}
+
+bool SymbolChecker::checkRain(int x, int y, int symbol) {
+	std::vector<Point> _8DIRECTIONS1 = { Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0), Point(1, 1), Point(1, -1), Point(-1, -1), Point(-1, 1) };
+	return isSurrounded(Point (x,y), _8DIRECTIONS1[(symbol & 0xf0000) >> 16], 2);
+}
+
+bool SymbolChecker::isSurrounded(Point pos, Point dir, int type) {
+		std::vector<Point> spread;
+		if (dir.first == 0) {
+			spread = { {-1, 0} , {1, 0} };
+		}
+		else {
+			spread = { {0, -1} , {0, 1} };
+		}
+		if (!(pos.first >= 0 && pos.first < width && pos.second >= 0 && pos.second < height)) {
+			return false;
+		}
+		for (int i : {0, 1}) {
+			if (get(pos + spread[i]) != PATH && (type == i || type == 2)) {
+				if (!isSurrounded(pos + (spread[i] * 2), dir, i)) {
+					return false;
+				}
+			}
+		}
+
+		if (get(pos + dir) != PATH) {
+			if (!isSurrounded(pos + (dir * 2), dir, 2)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+bool SymbolChecker::checkPointer(int x, int y, int symbol) {
+	int a = 0;
+	std::vector<int> distance = { INT_MAX, INT_MAX , INT_MAX , INT_MAX };
+	for (Point dir : {Point(2, 0), Point(-2, 0), Point(0, 2), Point(0, -2) }) {//DASW
+		int count = 0;
+		int x_tmp = x + dir.first / 2;
+		int y_tmp = y + dir.second / 2;
+		while (x_tmp >= 0 && x_tmp < width && y_tmp >= 0 && y_tmp < height && distance[a] == INT_MAX) {
+			if (get(Point(x_tmp, y_tmp)) == PATH) {
+				distance[a] = count;
+			}
+			x_tmp += dir.first; y_tmp += dir.second; count++;
+		}
+		a++;
+	}
+	std::vector<int> minbool = { 0, 0, 0, 0 };
+	int min = INT_MAX;
+	for (int v : distance) {
+		if (v <= min) min = v;
+	}
+	if (min == INT_MAX) return false;
+	a = 0;
+	for (int v : distance) {
+		if (v == min) {
+			minbool[a] = 1;
+		}
+		a++;
+	}
+
+	int num = minbool[0] * 8 + minbool[1] * 4 + minbool[2] * 2 + minbool[3];
+
+	if (num == 0) {
+		num = 15;
+	}
+	return num == ((symbol & 0xf0000) >> 16);
+}
+
+bool SymbolChecker::checkDiamond(int x, int y, int symbol) {
+	int count = 0;
+	std::set<Point> region = get_region({ x, y });
+	for (Point p : region) {
+		if (get(p) != 0) {
+			count++;
+		}
+	}
+	return count == (symbol & 0xF0000) >> 16;
+}
+
+bool SymbolChecker::checkDice(int x, int y) {
+	int targetCount = 0;
+	std::set<Point> region = get_region({ x, y });
+	for (Point p : region) {
+		if ((get(p) & 0xF000000) == Decoration::Dice) {
+			targetCount += (get(p) & 0xF0000) >> 16;
+		}
+	}
+	return static_cast<int>(region.size()) == targetCount;
+}
+
+bool SymbolChecker::checkBell(int x, int y, int symbol) {
+	Point pos = { x, y };
+	int dir = ((symbol & 0xF0000) >> 16);
+	std::vector<int> pattern = { get(pos + Point({1, 0})), get(pos + Point({0, 1})), get(pos + Point({-1, 0})), get(pos + Point({0, -1})) };
+	x += 2;
+	for (; y < height; y += 2) {
+		while (x < width) {
+			pos = Point(x, y);
+			int symbol2 = get(pos);
+			if ((symbol2 & 0xF000000) == Decoration::Bell) {
+				std::vector<int> pattern2 = { get(pos + Point({1, 0})), get(pos + Point({0, 1})), get(pos + Point({-1, 0})), get(pos + Point({0, -1})) };
+				int dir2 = ((symbol2 & 0xF0000) >> 16);
+				for (int i = 0; i < 4; i++) {
+					if ((pattern[(i + dir) % 4] == PATH) != (pattern2[(i + dir2) % 4] == PATH))
+						return false;
+				}
+				return true;
+			}
+			x += 2;
+		}
+		x = 1;
+	}
+	return true;
+}
+
+bool SymbolChecker::checkTent(int x, int y) {
+	Point pos = { x, y };
+	int edges = (get(pos + Point({ 1, 0 })) == PATH) + (get(pos + Point({ 0, 1 })) == PATH) + (get(pos + Point({ -1, 0 })) == PATH) + (get(pos + Point({ 0, -1 })) == PATH);
+	if (edges == 0) return false;
+	x += 2;
+	for (; y < height; y += 2) {
+		while (x < width) {
+			pos = Point(x, y);
+			int symbol2 = get(pos);
+			if ((symbol2 & 0xF000000) == Decoration::Tent) {
+				int edges2 = (get(pos + Point({ 1, 0 })) == PATH) + (get(pos + Point({ 0, 1 })) == PATH) + (get(pos + Point({ -1, 0 })) == PATH) + (get(pos + Point({ 0, -1 })) == PATH);
+				return edges == edges2;
+			}
+			x += 2;
+		}
+		x = 1;
+	}
+	return true;
+}
+
+bool SymbolChecker::checkCircle(int x, int y) {
+	std::set<Point> edges;
+	bool first = false;
+	for (int y2 = 1; y2 < height; y2 += 2) {
+		for (int x2 = 1; x2 < width; x2 += 2) {
+			Point pos = Point(x2, y2);
+			int symbol2 = get(pos);
+			if ((symbol2 & 0xF000000) == Decoration::Circle) {
+				if (!first && (x != x2 || y != y2))
+					return true;
+				first = true;
+				for (Point d : {Point(1, 0), Point(-1, 0), Point(0, 1), Point(0, -1) }) {
+					if (get(pos + d) == PATH) {
+						if (edges.count(d))
+							return false;
+						edges.insert(d);
+					}
+				}
+			}
+		}
+	}
+	return edges.size() == 4;
+}
+
+bool SymbolChecker::checkNewSymbolsF() {
+	return true;
+}
+
+std::set<Point> SymbolChecker::get_region(Point pos) {
+	std::shared_ptr<RegionKernel> kernel = get_kernel(pos);
+	return kernel->to_points(get_region_cells(*kernel, pos));
+}
+
+//The regions labeled by check_all(), or a new kernel for points of another parity (or outside of check_all)
+std::shared_ptr<RegionKernel> SymbolChecker::get_kernel(Point pos) {
+	if (regions && regions->contains(pos)) return regions;
+	return std::make_shared<RegionKernel>(grid, pos, pillarWidth > 0, false);
+}
+
+Bitboard SymbolChecker::get_region_cells(const RegionKernel& kernel, Point pos) {
+	int label = kernel.get_label(pos);
+	return label >= 0 ? kernel.get_regions()[label] : kernel.flood(pos);
+}
+
+std::set<int> SymbolChecker::get_symbols_in_region(const std::set<Point>& region) {
+	std::set<int> symbols;
+	for (Point p : region) {
+		if (grid[p.first][p.second]) symbols.insert(grid[p.first][p.second]);
+	}
+	return symbols;
+}
+
+bool SymbolChecker::checkArrowPillar(int x, int y)
+{
+	int symbol = grid[x][y];
+	if ((symbol & 0x700) == Decoration::Triangle && (symbol & 0xf0000) != 0) {
+		int count = 0;
+		if (grid[x - 1][y] == PATH) count++;
+		if (grid[x + 1][y] == PATH) count++;
+		if (grid[x][y - 1] == PATH) count++;
+		if (grid[x][y + 1] == PATH) count++;
+		return count == (symbol >> 16);
+	}
+	if ((symbol & 0x700) != Decoration::Arrow)
+		return true;
+	int targetCount = (symbol & 0xf000) >> 12;
+	Point dir = DIRECTIONS[(symbol & 0xf0000) >> 16];
+	x = (x + (dir.first > 2 ? -2 : dir.first) / 2 + pillarWidth) % pillarWidth; y += dir.second / 2;
+	int count = 0;
+	while (y >= 0 && y < height) {
+		if (grid[x][y] == PATH) {
+			if (++count > targetCount) return false;
+		}
+		x = (x + dir.first + pillarWidth) % pillarWidth; y += dir.second;
+	}
+	return count == targetCount;
+}
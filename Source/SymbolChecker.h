@@ -0,0 +1,45 @@
+#pragma once
+#include "GridTypes.h"
+#include "Bitboard.h"
+#include <memory>
+#include <set>
+#include <vector>
+
+//Rules for the custom symbols that the game doesn't know how to check.
+//The path is marked in the grid with PATH. Used by the symbol watchdog while the player traces, and by the solver.
+class SymbolChecker {
+public:
+	SymbolChecker();
+	void set_grid(const std::vector<std::vector<int>>& grid);
+	bool check_all();
+	bool check(int x, int y);
+	bool checkArrow(int x, int y, int symbol);
+	bool checkMine(int x, int y, int symbol);
+	bool checkHead(int x, int y, int symbol);
+	bool checkMushroom(int x, int y);
+	bool checkGhost();
+	bool checkBar(int x, int y, int symbol);
+	bool checkAntitriangle(int x, int y, int symbol);
+	int get(Point p);
+	bool check_it_is_corner(Point pos);
+	bool checkDart(int x, int y, int symbol);
+	bool checkRain(int x, int y, int symbol);
+	bool isSurrounded(Point pos, Point dir, int type);
+	bool checkPointer(int x, int y, int symbol);
+	bool checkDiamond(int x, int y, int symbol);
+	bool checkDice(int x, int y);
+	bool checkBell(int x, int y, int symbol);
+	bool checkTent(int x, int y);
+	bool checkCircle(int x, int y);
+	bool checkNewSymbolsF();
+	std::set<Point> get_region(Point pos);
+	std::shared_ptr<RegionKernel> get_kernel(Point pos);
+	Bitboard get_region_cells(const RegionKernel& kernel, Point pos);
+	std::set<int> get_symbols_in_region(const std::set<Point>& region);
+	bool checkArrowPillar(int x, int y);
+
+	std::vector<std::vector<int>> grid;
+	int width, height, pillarWidth;
+	std::vector<Point> DIRECTIONS;
+	std::shared_ptr<RegionKernel> regions; //Regions of the path, rebuilt by check_all()
+};
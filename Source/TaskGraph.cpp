@@ -0,0 +1,95 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "TaskGraph.h"
+#include <thread>
+
+size_t TaskGraph::add(std::function<void()> work, const std::vector<size_t>& after)
+{
+	_tasks.push_back({ work, after, Waiting, WriteQueue(), nullptr });
+	return _tasks.size() - 1;
+}
+
+void TaskGraph::run(int numThreads, const std::function<void(size_t)>& commit)
+{
+	if (numThreads <= 0) numThreads = static_cast<int>(std::thread::hardware_concurrency());
+	if (numThreads <= 0) numThreads = 1;
+	Memory memory("witness64_d3d11.exe");
+	_stopped = false;
+	std::vector<std::thread> threads;
+	for (int i = 0; i < numThreads; i++) threads.emplace_back(&TaskGraph::work, this);
+
+	//Write each task once it is done, in order
+	std::exception_ptr error;
+	for (size_t i = 0; i < _tasks.size(); i++) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_changed.wait(lock, [&] { return _tasks[i].state == Finished; });
+		lock.unlock();
+		if (!error) error = _tasks[i].error;
+		if (!error) {
+			try {
+				memory.Flush(_tasks[i].writes);
+			}
+			catch (...) {
+				error = std::current_exception();
+			}
+		}
+		_tasks[i].writes = WriteQueue();
+		lock.lock();
+		_tasks[i].state = Written;
+		if (error) _stopped = true;
+		lock.unlock();
+		_changed.notify_all();
+		if (!error) commit(i);
+	}
+	for (std::thread& thread : threads) thread.join();
+	_tasks.clear();
+	if (error) std::rethrow_exception(error);
+}
+
+void TaskGraph::work()
+{
+	while (true) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		size_t index = _tasks.size();
+		_changed.wait(lock, [&] {
+			index = next_ready();
+			if (index < _tasks.size()) return true;
+			for (const Task& task : _tasks) if (task.state == Waiting) return false;
+			return true; //Nothing left to start
+		});
+		if (index == _tasks.size()) return;
+		Task& task = _tasks[index];
+		task.state = Running;
+		bool stopped = _stopped;
+		lock.unlock();
+		if (!stopped) {
+			Memory::writeQueue = &task.writes;
+			try {
+				task.work();
+			}
+			catch (...) {
+				task.error = std::current_exception();
+			}
+			Memory::writeQueue = nullptr;
+		}
+		lock.lock();
+		task.state = Finished;
+		lock.unlock();
+		_changed.notify_all();
+	}
+}
+
+size_t TaskGraph::next_ready() const
+{
+	for (size_t i = 0; i < _tasks.size(); i++) {
+		if (_tasks[i].state != Waiting) continue;
+		bool ready = true;
+		for (size_t before : _tasks[i].after) {
+			if (_tasks[before].state != Written) ready = false;
+		}
+		if (ready) return i;
+	}
+	return _tasks.size();
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "Memory.h"
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+//Runs tasks that depend on each other on several threads, while the game sees the same thing as if they had run one at a time.
+//The game writes each task makes are held back in its own queue (see WriteQueue), and the thread that called run() makes them in the order the tasks were added.
+//A task only starts once the tasks it depends on have been written, so tasks must not read panels written by tasks they don't depend on.
+class TaskGraph {
+public:
+	//Returns the index of the task. after - the (earlier) tasks it depends on
+	size_t add(std::function<void()> work, const std::vector<size_t>& after);
+	//Run all of the tasks on numThreads threads. commit is called on this thread after each task is written, in order.
+	//If a task throws, nothing from it or any later task is written, and the exception is thrown from here once the threads are done.
+	void run(int numThreads, const std::function<void(size_t)>& commit);
+
+private:
+	enum State { Waiting, Running, Finished, Written };
+
+	struct Task {
+		std::function<void()> work;
+		std::vector<size_t> after;
+		State state;
+		WriteQueue writes;
+		std::exception_ptr error;
+	};
+
+	void work();
+	size_t next_ready() const; //The first task that can start, or the number of tasks if there isn't one
+
+	std::vector<Task> _tasks;
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	bool _stopped; //A task failed, so the rest are skipped
+};
@@ -0,0 +1,158 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+//Times Solver against ParallelSolver on the panels from PuzzleList::GenerateAllH with the biggest search trees:
+//7x7 symmetry panels, panels with several starts, and the Mountain pillars.
+//The layouts (size, symmetry, starts and exits) are copied from PuzzleList and Special::initPillarSymmetry. Where the generator picks the starts
+//and exits at random, fixed ones are used instead. Gaps and symbols are placed from a fixed seed, in the numbers the generator uses,
+//so every run searches the same tree. Gaps that would cut the starts off from the exits are left out, as the generator would.
+//Some of these trees take hours to search, so each search stops at the time budget, and the speed is compared as points searched per millisecond.
+//Searches that finish in time are also checked to find the same number of solutions.
+//Needs none of the game, so it builds anywhere:
+//  g++ -std=c++17 -O2 -pthread -I.. SolverBenchmark.cpp ../Solver.cpp ../ParallelSolver.cpp ../PathChecker.cpp ../Bitboard.cpp ../SymbolChecker.cpp ../BarPatterns.cpp -o SolverBenchmark
+//  ./SolverBenchmark [max threads] [time budget in milliseconds]
+
+#include "Solver.h"
+#include "ParallelSolver.h"
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <thread>
+
+struct BenchmarkPanel {
+	const char* name;
+	int width, height; //In cells, as in Generate::setGridSize
+	int pillarWidth; //0 unless the panel is a pillar
+	std::vector<Point> starts, exits; //Before symmetry
+	std::function<Point(int, int, int, int)> symmetry; //Maps (x, y) on a grid of (width, height) points, or nullptr
+	int gaps;
+	std::vector<std::pair<int, int>> symbols; //Symbol and amount, as passed to Generate::generate. Triangles get 1 to 3 at random.
+};
+
+static std::vector<BenchmarkPanel> GetPanels()
+{
+	auto rotational = [](int x, int y, int w, int h) { return Point(w - 1 - x, h - 1 - y); };
+	auto parallelH = [](int x, int y, int, int h) { return Point(x, y == h / 2 ? h / 2 : (y + (h + 1) / 2) % (h + 1)); };
+	auto pillarParallel = [](int x, int y, int w, int) { return Point(x + w / 2, y); };
+	auto pillarVertical = [](int x, int y, int w, int) { return Point(w / 2 - x, y); };
+	auto pillarRotational = [](int x, int y, int w, int h) { return Point(w / 2 - x, h - 1 - y); };
+	return {
+		{ "0x00084 Weird Symmetry 7x7", 7, 7, 0, { Point(4, 4), Point(10, 4), Point(4, 10), Point(10, 10) }, { Point(4, 0), Point(14, 4), Point(0, 10), Point(10, 14) }, rotational, 15, { } },
+		{ "0x00086 Parallel Symmetry 7x7", 7, 7, 0, { Point(0, 14) }, { Point(14, 8) }, parallelH, 17, { } },
+		{ "0x002C2 Tutorial 6x6, 3 starts", 6, 6, 0, { Point(0, 12), Point(6, 6), Point(12, 12) }, { Point(12, 0) }, nullptr, 0,
+			{ { Decoration::Eraser | Decoration::Color::Black, 1 }, { Decoration::Triangle | Decoration::Color::Black, 12 } } },
+		{ "0x0383F Mountain Pillar 6x5", 6, 5, 12, { Point(0, 10), Point(6, 10) }, { Point(0, 0), Point(6, 0) }, pillarParallel, 0,
+			{ { Decoration::Triangle | Decoration::Color::Orange, 8 } } },
+		{ "0x03859 Mountain Pillar 6x4", 6, 4, 12, { Point(0, 8), Point(6, 0) }, { Point(6, 8), Point(0, 0) }, pillarRotational, 0,
+			{ { Decoration::Stone | Decoration::Color::Black, 2 }, { Decoration::Stone | Decoration::Color::White, 2 } } },
+		{ "0x09E5A Mountain Pillar 6x5, 5 starts", 6, 5, 12, { Point(2, 10), Point(4, 10), Point(0, 4), Point(8, 6), Point(10, 2) }, { Point(2, 0), Point(4, 0) }, pillarVertical, 0,
+			{ { Decoration::Star | Decoration::Color::Orange, 1 }, { Decoration::Star | Decoration::Color::Blue, 1 }, { Decoration::Dot, 4 } } },
+	};
+}
+
+//Whether a line from one of the starts can still get to one of the exits
+static bool Connected(const std::vector<std::vector<int>>& grid, const std::set<Point>& starts, const std::set<Point>& exits)
+{
+	int width = static_cast<int>(grid.size()), height = static_cast<int>(grid[0].size());
+	std::set<Point> seen(starts.begin(), starts.end());
+	std::vector<Point> open(starts.begin(), starts.end());
+	while (open.size()) {
+		Point p = open.back();
+		open.pop_back();
+		if (exits.count(p)) return true;
+		for (Point dir : { Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0) }) {
+			Point edge = p + dir, next = p + dir * 2; //Both wrap around pillars
+			if (next.second < 0 || next.second >= height || (!Point::pillarWidth && (next.first < 0 || next.first >= width))) continue;
+			if ((grid[edge.first][edge.second] & GAP) || seen.count(next)) continue;
+			seen.insert(next);
+			open.push_back(next);
+		}
+	}
+	return false;
+}
+
+//Set up a solver for the panel the way Generate::check_solution_count does
+static Solver MakeSolver(const BenchmarkPanel& panel)
+{
+	Point::pillarWidth = panel.pillarWidth;
+	int width = panel.pillarWidth ? panel.pillarWidth : panel.width * 2 + 1;
+	int height = panel.height * 2 + 1;
+	auto sym = [&](Point p) { return panel.symmetry ? panel.symmetry(p.first, p.second, width, height) : p; };
+	std::vector<std::vector<int>> grid(width, std::vector<int>(height, 0));
+	std::set<Point> starts(panel.starts.begin(), panel.starts.end()), exits(panel.exits.begin(), panel.exits.end());
+	for (Point p : panel.starts) starts.insert(sym(p));
+	for (Point p : panel.exits) exits.insert(sym(p));
+	std::mt19937 random(0);
+	for (int i = 0, tries = 0; i < panel.gaps && tries < 1000; tries++) {
+		Point p(static_cast<int>(random() % width), static_cast<int>(random() % height));
+		if ((p.first + p.second) % 2 == 0 || grid[p.first][p.second] || sym(p) == p) continue;
+		int gap = p.first % 2 == 0 ? Decoration::Gap_Column : Decoration::Gap_Row;
+		grid[p.first][p.second] = grid[sym(p).first][sym(p).second] = gap;
+		if (Connected(grid, starts, exits)) i++;
+		else grid[p.first][p.second] = grid[sym(p).first][sym(p).second] = 0;
+	}
+	for (const std::pair<int, int>& symbol : panel.symbols) {
+		for (int i = 0; i < symbol.second;) {
+			Point p(static_cast<int>(random() % width), static_cast<int>(random() % height));
+			bool cell = p.first % 2 == 1 && p.second % 2 == 1;
+			if (symbol.first == Decoration::Dot ? cell || starts.count(p) || exits.count(p) : !cell) continue;
+			if (grid[p.first][p.second]) continue;
+			int value = symbol.first;
+			if (value == Decoration::Dot) value = DOT | INTERSECTION;
+			if ((value & 0xF00) == Decoration::Triangle) value |= (1 + static_cast<int>(random() % 3)) << 16;
+			grid[p.first][p.second] = value;
+			i++;
+		}
+	}
+	Solver solver(grid, starts, exits, panel.pillarWidth);
+	if (panel.symmetry) {
+		std::vector<std::vector<Point>> symmetry(width, std::vector<Point>(height));
+		for (int x = 0; x < width; x++) {
+			for (int y = 0; y < height; y++) symmetry[x][y] = panel.symmetry(x, y, width, height);
+		}
+		solver.set_symmetry(symmetry);
+	}
+	return solver;
+}
+
+static void PrintStats(const char* name, const SolverStats& stats, double baseline)
+{
+	double speed = stats.nodes / (stats.milliseconds > 0 ? stats.milliseconds : 1);
+	printf("  %-10s %10.1f ms %12lld points %10.0f points/ms  %5.2fx  %d solutions%s\n", name, stats.milliseconds, stats.nodes, speed,
+		baseline > 0 ? speed / baseline : 1, stats.solutions, stats.timedOut ? " (out of time)" : "");
+	fflush(stdout);
+}
+
+int main(int argc, char* argv[])
+{
+	int maxThreads = argc > 1 ? atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency());
+	if (maxThreads < 1) maxThreads = 1;
+	double timeBudget = argc > 2 ? atof(argv[2]) : 10000;
+	std::vector<int> threadCounts;
+	for (int threads = 1; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+	threadCounts.push_back(maxThreads);
+	bool failed = false;
+	for (const BenchmarkPanel& panel : GetPanels()) {
+		printf("%s\n", panel.name);
+		Solver solver = MakeSolver(panel);
+		solver.count_solutions(0, timeBudget);
+		SolverStats serial = solver.get_stats();
+		double baseline = serial.nodes / (serial.milliseconds > 0 ? serial.milliseconds : 1);
+		PrintStats("serial", serial, 0);
+		for (int threads : threadCounts) {
+			ParallelSolver parallel(MakeSolver(panel), threads);
+			parallel.count_solutions(0, timeBudget);
+			SolverStats stats = parallel.get_stats();
+			char name[32];
+			snprintf(name, sizeof(name), "%d threads", threads);
+			PrintStats(name, stats, baseline);
+			if (!serial.timedOut && !stats.timedOut && stats.solutions != serial.solutions) {
+				printf("  Wrong number of solutions!\n");
+				failed = true;
+			}
+		}
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+//Runs the generators and solvers on many threads at once, to check that they don't share anything they change.
+//Every thread makes pivot panels from its own seed and solves them, and every other thread works on a pillar, so Point::pillarWidth differs between threads.
+//Each thread's work is first done alone to get the expected results. Then all of them run together, and have to come out the same.
+//Build it with ThreadSanitizer, which reports any data race between the threads:
+//  g++ -std=c++17 -O1 -g -fsanitize=thread -pthread -I.. ThreadStress.cpp ../PivotGenerate.cpp ../Random.cpp ../Solver.cpp ../ParallelSolver.cpp ../PathChecker.cpp ../Bitboard.cpp ../SymbolChecker.cpp ../BarPatterns.cpp -o ThreadStress
+//  ./ThreadStress [threads] [panels per thread]
+
+#include "PivotGenerate.h"
+#include "ParallelSolver.h"
+#include "Random.h"
+#include "Solver.h"
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+//Make panels from the seed, and return their grids and solution counts
+static std::vector<int> Work(int seed, int numPanels)
+{
+	std::vector<int> results;
+	Random::seed(seed);
+	bool pillar = seed % 2 == 1;
+	Point::pillarWidth = pillar ? 12 : 0;
+	for (int i = 0; i < numPanels; i++) {
+		if (pillar) {
+			//A 6x4 pillar with the line going from the bottom to the top
+			std::vector<std::vector<int>> grid(12, std::vector<int>(9, 0));
+			int x = 2 * (Random::rand() % 6);
+			Solver solver(grid, { Point(x, 8) }, { Point(x + 6, 0) }, 12);
+			results.push_back(solver.count_solutions(1000, 0));
+			continue;
+		}
+		PivotGenerate pivot(9, 9);
+		while (!pivot.generate({ { Decoration::Triangle | Decoration::Color::Orange, 3 }, { Decoration::Stone | Decoration::Color::Black, 2 },
+			{ Decoration::Stone | Decoration::Color::White, 2 } }));
+		for (const std::vector<int>& column : pivot.get_grid()) results.insert(results.end(), column.begin(), column.end());
+		for (Point exit : pivot.get_exits()) {
+			Solver solver(pivot.get_grid(), { pivot.get_start() }, { exit }, 0);
+			//Every few panels, solve on more threads from inside this one
+			if (i % 4 == 0) results.push_back(ParallelSolver(solver, 2).count_solutions(0, 0));
+			else results.push_back(solver.count_solutions(0, 0));
+		}
+	}
+	return results;
+}
+
+int main(int argc, char* argv[])
+{
+	int numThreads = argc > 1 ? atoi(argv[1]) : 8;
+	int numPanels = argc > 2 ? atoi(argv[2]) : 20;
+	std::vector<std::vector<int>> expected, results(numThreads);
+	for (int i = 0; i < numThreads; i++) expected.push_back(Work(i + 1, numPanels));
+	std::vector<std::thread> threads;
+	for (int i = 0; i < numThreads; i++) threads.emplace_back([i, numPanels, &results]() { results[i] = Work(i + 1, numPanels); });
+	for (std::thread& thread : threads) thread.join();
+	int failed = 0;
+	for (int i = 0; i < numThreads; i++) {
+		if (results[i] != expected[i]) {
+			printf("Thread %d came out differently than when it ran alone\n", i);
+			failed++;
+		}
+	}
+	printf("%d threads, %d panels each: %s\n", numThreads, numPanels, failed ? "FAILED" : "OK");
+	return failed ? 1 : 0;
+}
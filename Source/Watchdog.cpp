@@ -8,8 +8,14 @@
 #include <iostream>
 #include <stdlib.h>
 
+thread_local std::vector<Watchdog*>* Watchdog::heldBack = nullptr;
+
 void Watchdog::start()
 {
+	if (heldBack) {
+		heldBack->push_back(this);
+		return;
+	}
 	std::thread{ &Watchdog::run, this }.detach();
 }
 
@@ -38,6 +44,7 @@ void KeepWatchdog::action() {
 //Symbol Watchdog - To run the custom symbol puzzles
 
 void SymbolWatchdog::action() {
+	Point::pillarWidth = pillarWidth; //The panel was read on another thread
 	int length = ReadPanelData<int>(id, TRACED_EDGES);
 	if (length != tracedLength) {
 		complete = false;
@@ -48,20 +55,22 @@ void SymbolWatchdog::action() {
 	}
 	sleepTime = 0.01f;
 	if (length == tracedLength) return;
+	if (!pathChecker) pathChecker = std::make_shared<PathChecker>(backupGrid, pillarWidth);
 	initPath();
+	pathChecker->set_path(pathPoints);
 	if (complete) {
-		for (int x = 1; x < width; x++) {
-			for (int y = 1; y < height; y++) {
-				if (!check(x, y)) {
-					WriteArray<int>(id, SEQUENCE, { 69 }, true);
-					WritePanelData<int>(id, SEQUENCE_LEN, { 1 });
-					return;
-				}
-			}
+		if (pathChecker->violated() || !check_all()) {
+			WriteArray<int>(id, SEQUENCE, { 69 }, true);
+			WritePanelData<int>(id, SEQUENCE_LEN, { 1 });
+			return;
 		}
 		WritePanelData<uint64_t>(id, SEQUENCE, { 0 });
 		WritePanelData<int>(id, SEQUENCE_LEN, { 0 });
 	}
+	else if (pathChecker->violated()) { //Already broken, so set the panel to fail before the line is even finished
+		WriteArray<int>(id, SEQUENCE, { 69 }, true);
+		WritePanelData<int>(id, SEQUENCE_LEN, { 1 });
+	}
 }
 
 void SymbolWatchdog::initPath()
@@ -79,6 +88,11 @@ void SymbolWatchdog::initPath()
 		}
 	}
 	grid = backupGrid;
+	pathPoints.clear();
+	auto mark = [&](int x, int y) {
+		grid[x][y] = PATH;
+		pathPoints.emplace_back(Point(x, y));
+	};
 	tracedLength = numTraced;
 	complete = false;
 	if (traced.size() == 0) return;
@@ -103,134 +117,19 @@ void SymbolWatchdog::initPath()
 		if (pillarWidth > 0) {
 			x1 = (p1 % (width / 2)) * 2, y1 = height - 1 - (p1 / (width / 2)) * 2;
 			x2 = (p2 % (width / 2)) * 2, y2 = height - 1 - (p2 / (width / 2)) * 2;
-			grid[x1][y1] = PATH;
-			grid[x2][y2] = PATH;
-			if (x1 == x2 || x1 == x2 + 2 || x1 == x2 - 2) grid[(x1 + x2) / 2][(y1 + y2) / 2] = PATH;
-			else grid[width - 1][(y1 + y2) / 2] = PATH;
+			mark(x1, y1);
+			if (x1 == x2 || x1 == x2 + 2 || x1 == x2 - 2) mark((x1 + x2) / 2, (y1 + y2) / 2);
+			else mark(width - 1, (y1 + y2) / 2);
+			mark(x2, y2);
 		}
 		else {
-			grid[x1][y1] = PATH;
-			grid[x2][y2] = PATH;
-			grid[(x1 + x2) / 2][(y1 + y2) / 2] = PATH;
+			mark(x1, y1);
+			mark((x1 + x2) / 2, (y1 + y2) / 2);
+			mark(x2, y2);
 		}
 	}
 }
 
-bool SymbolWatchdog::check(int x, int y)
-{
-	int symbol = grid[x][y];
-	int type = symbol & 0xF000700;
-	if (type == Decoration::Arrow) {
-		return checkArrow(x, y, symbol);
-	}
-	if (type == Decoration::Mine) {
-		return checkMine(x, y, symbol);
-	}
-	if (type == Decoration::Head) {
-		return checkHead(x, y, symbol);
-	}
-	if (type == Decoration::Mushroom) {
-		return checkMushroom(x, y, symbol);
-	}
-	if (type == Decoration::Ghost) {
-		return checkGhost(x, y, symbol);
-	}
-	if (type == Decoration::Bar) {
-		return checkBar(x, y, symbol);
-	}
-	if (type == Decoration::Antitriangle) {
-		return checkAntitriangle(x, y, symbol);
-	}
-	if (type == Decoration::Dart) {
-		return checkDart(x, y, symbol);
-	}
-	if (type == Decoration::Rain) {
-		return checkRain(x, y, symbol);
-	}
-	if (type == Decoration::Pointer) {
-		return checkPointer(x, y, symbol);
-	}
-	if (type == Decoration::Diamond) {
-		return checkDiamond(x, y, symbol);
-	}
-	if (type == Decoration::Dice) {
-		return checkDice(x, y, symbol);
-	}
-	if (type == Decoration::Bell) {
-		return checkBell(x, y, symbol);
-	}
-	if (type == Decoration::Tent) {
-		return checkTent(x, y, symbol);
-	}
-	if (type == Decoration::Circle) {
-		return checkCircle(x, y, symbol);
-	}
-	if (type == Decoration::NewSymbolsF) {
-		return checkNewSymbolsF(x, y, symbol);
-	}
-	return true;
-}
-
-bool SymbolWatchdog::checkArrow(int x, int y, int symbol)
-{
-	if (pillarWidth > 0) return checkArrowPillar(x, y);
-	int targetCount = (symbol & 0xf000) >> 12;
-	Point dir = DIRECTIONS[(symbol & 0xf0000) >> 16];
-	x += dir.first / 2; y += dir.second / 2;
-	int count = 0;
-	while (x >= 0 && x < width && y >= 0 && y < height) {
-		if (grid[x][y] == PATH) {
-			if (++count > targetCount)
-				return false;
-		}
-		x += dir.first; y += dir.second;
-	}
-	return count == targetCount;
-}
-
-bool SymbolWatchdog::checkMine(int x, int y,int symbol) {
-	Point pos = Point(x, y);
-	std::set<Point> region = get_region_for_watchdog(Point(x, y));
-	std::set<Point> nearby = {
-			pos + Point(2,0), pos + Point(0,2), pos + Point(0,-2), pos + Point(-2,0),
-			pos + Point(2,2), pos + Point(-2,2), pos + Point(-2,-2), pos + Point(2,-2),
-	};
-	int num = 0;
-	for (Point a : nearby) {
-		for (Point b : region) {
-			if (a.first == b.first && a.second == b.second) {
-				num += 1;
-			}
-		}
-	}
-	if ((pos.first == 1 || pos.first == width - 2) && (pos.second == 1 || pos.second == height - 2))
-	{
-		num = 3 - num;
-	}
-	else if ((pos.first == 1 || pos.first == width - 2) || (pos.second == 1 || pos.second == height - 2))
-	{
-		num = 5 - num;
-	}
-	else
-	{
-		num = 8 - num;
-	}
-
-	return num == (0xf0000 & symbol) >> 16;
-}
-
-bool SymbolWatchdog::checkHead(int x, int y, int symbol) {
-	if ((symbol & 0xf0000) >> 16 == 9) return true;
-	std::vector<Point> _8dir = { Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0), Point(2, 2), Point(2, -2), Point(-2, -2), Point(-2, 2) };
-	Point dir = _8dir[(symbol & 0xf0000) >> 16];
-	for (Point p : get_region_for_watchdog(Point(x, y))) {
-		if (((dir.first == 0 || (p.first - x) * dir.first >  0) && (dir.second == 0 || (p.second - y) * dir.second > 0))) {
-			if (!(grid[p.first][p.second] == 0x2090000 || grid[p.first][p.second]  == 0x600 || grid[p.first][p.second] == 0x0 || grid[p.first][p.second] == 0xA00)) return false;
-		}
-	}
-	return true;
-}
-
 void SymbolWatchdog::DebugLog(int i) {
 	std::string s = std::to_string(i);
 	const char* mbs = s.data();
@@ -242,425 +141,8 @@ void SymbolWatchdog::DebugLog(int i) {
 	OutputDebugStringW(ws.data());
 }
 
-bool SymbolWatchdog::checkMushroom(int x, int y, int symbol) {
-	std::vector<Point> DIRECTIONS = { Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0) };
-	for (Point dir : DIRECTIONS) {
-		int local_x = x + dir.first / 2;
-		int local_y = y + dir.second / 2;
-		bool flag = false;
-		while ((local_x >= 0 && local_x < width && local_y >= 0 && local_y < height) && !flag) {
-			if (grid[local_x][local_y] == PATH) flag = true;
-			local_x += dir.first; local_y += dir.second;
-		}
-		if (!flag) return false;
-	}
-	
-	return true;
-}
-
-bool SymbolWatchdog::checkGhost(int x, int y, int symbol) {
-	int num = 0;
-	std::set<Point> open;
-	for (int x = 1; x < width; x += 2) {
-		for (int y = 1; y < height; y += 2) {
-			open.emplace(Point(x, y));
-		}
-	}
-	while (open.size() > 0) {
-		Point pos = pick_random_fw(open);
-		bool flag = false;
-		for (Point p : get_region_for_watchdog(pos)) {
-			if(flag && (get(p) & 0xf000000) == Decoration::Ghost)
-			{
-				return false;
-			}
-			else if ((get(p) & 0xf000000) == Decoration::Ghost) {
-				flag = true;
-			}
-			open.erase(p);
-		};
-		if (!flag) {
-			return false;
-		}
-	}
-	return true;
-}
-
 template <class T> T SymbolWatchdog::pick_random_fw(const std::set<T>& set) { auto it = set.begin(); std::advance(it, Random::rand() % set.size()); return *it; }
 
-bool SymbolWatchdog::checkBar(int x, int y, int symbol) {
-	int num = (symbol & 0xF0000) >> 16;
-	Point pos = Point(x,y);
-	//0:X(null) 1:(OOCC) 2:(COOC) 3:(CCOO) 4:(OCCO) 5:(COOO) 6:(OCOO) 7:(OOCO) 8:(OOOC) 9:(OOOO) A:(OCOC) B:(COCO) C:Gap_Column D:Gap_Row
-	std::vector<int> region_data = get_region_grid_patterns_fw(get_region_points_fw(pos));
-	std::set<Point> symbols_data = get_region_for_watchdog(pos);
-	for (Point p : symbols_data) {
-		if ((grid[p.first][p.second] & 0xF0F0000) == (symbol & 0xF0F0000)) {
-			region_data[(grid[p.first][p.second] & 0xF0000) >> 16] -= 1;
-		}
-	}
-	return region_data[num] == 0;
-}
-
-std::set<Point> SymbolWatchdog::get_region_points_fw(Point pos) {
-	std::set<Point> result;
-	for (Point a : get_region_for_watchdog(pos)) {
-		for (Point dir : { Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0), Point(1, 1), Point(1, -1), Point(-1, -1), Point(-1, 1) }) {
-			result.insert(a + dir);
-		}
-	}
-	return result;
-}
-
-//0:X(null) 1:(OOCC) 2:(COOC) 3:(CCOO) 4:(OCCO) 5:(COOO) 6:(OCOO) 7:(OOCO) 8:(OOOC) 9:(OOOO) A:(OCOC) B:(COCO) C:Gap_Column D:Gap_Row
-std::vector<int> SymbolWatchdog::get_region_grid_patterns_fw(std::set<Point> points) {
-	std::vector<int> result(14, 0);
-	for (Point p : points) {
-		if (p.first % 2 == 1 && p.second % 2 == 0 && grid[p.first][p.second] != PATH) {
-			if (grid[p.first][p.second] == 0x300000 || grid[p.first][p.second] == 0x500000) {
-				result[0xD] += 1;
-			}
-			else {
-				result[0xB] += 1;
-			}
-			continue;
-		}
-		else if (p.first % 2 == 0 && p.second % 2 == 1 && grid[p.first][p.second] != PATH) {
-			if (grid[p.first][p.second] == 0x300000 || grid[p.first][p.second] == 0x500000) {
-				result[0xC] += 1;
-			}
-			else {
-				result[0xA] += 1;
-			}
-			continue;
-		}
-
-		std::vector<bool> _4dir = { false,false,false,false };
-		std::vector<std::vector<bool>> data = {
-			{ true, true, false, false },
-			{ false, true, true, false },
-			{ false, false, true, true },
-			{ true, false, false, true },
-			{ false, true, true, true },
-			{ true, false, true, true },
-			{ true, true, false, true },
-			{ true, true, true, false },
-			{ true, true, true, true },
-		};
-		int count = 0;
-
-		for (Point dir : {Point(0, -1), Point(1, 0), Point(0, 1), Point(-1, 0)}) {
-			if ((p + dir).first < 0 || (p + dir).second < 0 || (p + dir).first >= width || (p + dir).second >= height || grid[p.first][p.second] == PATH) 
-			{
-				_4dir[count] = false;
-			}
-			else if (grid[(p + dir).first][(p + dir).second] != PATH) {
-				_4dir[count] = true;
-			}
-			count++;
-		}
-
-		count = 0;
-		for (std::vector<bool> d : data) {
-			count++;
-			if (_4dir == d) {
-				result[count] += 1;
-			}
-		}
-
-	}
-	return result;
-}
-
-bool SymbolWatchdog::checkAntitriangle(int x, int y, int symbol) {
-	int num = 0;
-	for (Point c : {Point(1, 1), Point(1, -1), Point(-1, -1), Point(-1, 1)}) {
-		if (check_it_is_corner(Point(x + c.first,y + c.second))) {
-			num += 1;
-		}
-	}
-
-	return num == (symbol & 0xf0000) >> 16;
-}
-
-int SymbolWatchdog::get(Point p) { return grid[p.first][p.second]; }
-
-bool SymbolWatchdog::check_it_is_corner(Point pos) {
-	std::vector<bool> _4dir = { false,false,false,false };
-	int i = 0;
-	for (Point c : {Point(0, -1), Point(1, 0), Point(0, 1), Point(-1, 0)}) {
-		if ((pos + c).first < 0 || (pos + c).second < 0 || (pos + c).first >= width || (pos + c).second >= height)
-		{
-			_4dir[i] = false;
-		}
-		else if (get(pos + c) == PATH) {
-			_4dir[i] = true;
-		}
-		i++;
-	}
-
-	std::vector<std::vector<bool>> data = {
-		{ true, true, false, false },
-		{ false, true, true, false },
-		{ false, false, true, true },
-		{ true, false, false, true },
-		{ false, true, true, true },
-		{ true, false, true, true },
-		{ true, true, false, true },
-		{ true, true, true, false },
-		{ true, true, true, true },
-	};
-
-	for (std::vector<bool> d : data) {
-		if (_4dir == d)
-		{
-			return true;
-		}
-	}
-	return false;
-}
-
-//
-bool SymbolWatchdog::checkDart(int x, int y, int symbol) {
-	int targetCount = (symbol & 0xf0000) >> 16;//the number
-	Point dir = DIRECTIONS[(symbol & 0xf000) >> 12];//the direction
-	int count = 0;
-	std::set<Point> pointset = get_region_for_watchdog(Point(x, y));
-	while (x >= 0 && x < width && y >= 0 && y < height) {
-		x += dir.first; y += dir.second;
-		for (Point p : pointset) {
-			if (p == Point(x, y)) {
-				count += 1;
-			}
-		}
-	}
-
-	DebugLog(count);
-	DebugLog(targetCount);
-	return count == targetCount;
-}
-
-bool SymbolWatchdog::checkRain(int x, int y, int symbol) {
-	std::vector<Point> _8DIRECTIONS1 = { Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0), Point(1, 1), Point(1, -1), Point(-1, -1), Point(-1, 1) };
-	return isSurrounded(Point (x,y), _8DIRECTIONS1[(symbol & 0xf0000) >> 16], 2);
-}
-
-bool SymbolWatchdog::isSurrounded(Point pos, Point dir, int type) {
-		std::vector<Point> spread;
-		if (dir.first == 0) {
-			spread = { {-1, 0} , {1, 0} };
-		}
-		else {
-			spread = { {0, -1} , {0, 1} };
-		}
-		if (!(pos.first >= 0 && pos.first < width && pos.second >= 0 && pos.second < height)) {
-			return false;
-		}
-		for (int i : {0, 1}) {
-			if (get(pos + spread[i]) != PATH && (type == i || type == 2)) {
-				if (!isSurrounded(pos + (spread[i] * 2), dir, i)) {
-					return false;
-				}
-			}
-		}
-
-		if (get(pos + dir) != PATH) {
-			if (!isSurrounded(pos + (dir * 2), dir, 2)) {
-				return false;
-			}
-		}
-
-		return true;
-	}
-
-bool SymbolWatchdog::checkPointer(int x, int y, int symbol) {
-	int a = 0;
-	std::vector<int> distance = { INT_MAX, INT_MAX , INT_MAX , INT_MAX };
-	for (Point dir : {Point(2, 0), Point(-2, 0), Point(0, 2), Point(0, -2) }) {//DASW
-		int count = 0;
-		int x_tmp = x + dir.first / 2;
-		int y_tmp = y + dir.second / 2;
-		while (x_tmp >= 0 && x_tmp < width && y_tmp >= 0 && y_tmp < height && distance[a] == INT_MAX) {
-			if (get(Point(x_tmp, y_tmp)) == PATH) {
-				distance[a] = count;
-			}
-			x_tmp += dir.first; y_tmp += dir.second; count++;
-		}
-		a++;
-	}
-	std::vector<int> minbool = { 0, 0, 0, 0 };
-	int min = INT_MAX;
-	for (int v : distance) {
-		if (v <= min) min = v;
-	}
-	if (min == INT_MAX) return false;
-	a = 0;
-	for (int v : distance) {
-		if (v == min) {
-			minbool[a] = 1;
-		}
-		a++;
-	}
-
-	int num = minbool[0] * 8 + minbool[1] * 4 + minbool[2] * 2 + minbool[3];
-
-	if (num == 0) {
-		num = 15;
-	}
-	return num == ((symbol & 0xf0000) >> 16);
-}
-
-bool SymbolWatchdog::checkDiamond(int x, int y, int symbol) {
-	int count = 0;
-	std::set<Point> region = get_region_for_watchdog({ x, y });
-	for (Point p : region) {
-		if (get(p) != 0) {
-			count++;
-		}
-	}
-	return count == (symbol & 0xF0000) >> 16;
-}
-
-bool SymbolWatchdog::checkDice(int x, int y, int symbol) {
-	int targetCount = 0;
-	std::set<Point> region = get_region_for_watchdog({ x, y });
-	for (Point p : region) {
-		if ((get(p) & 0xF000000) == Decoration::Dice) {
-			targetCount += (get(p) & 0xF0000) >> 16;
-		}
-	}
-	return region.size() == targetCount;
-}
-
-bool SymbolWatchdog::checkBell(int x, int y, int symbol) {
-	Point pos = { x, y };
-	int dir = ((symbol & 0xF0000) >> 16);
-	std::vector<int> pattern = { get(pos + Point({1, 0})), get(pos + Point({0, 1})), get(pos + Point({-1, 0})), get(pos + Point({0, -1})) };
-	x += 2;
-	for (; y < height; y += 2) {
-		while (x < width) {
-			pos = Point(x, y);
-			int symbol2 = get(pos);
-			if ((symbol2 & 0xF000000) == Decoration::Bell) {
-				std::vector<int> pattern2 = { get(pos + Point({1, 0})), get(pos + Point({0, 1})), get(pos + Point({-1, 0})), get(pos + Point({0, -1})) };
-				int dir2 = ((symbol2 & 0xF0000) >> 16);
-				for (int i = 0; i < 4; i++) {
-					if ((pattern[(i + dir) % 4] == PATH) != (pattern2[(i + dir2) % 4] == PATH))
-						return false;
-				}
-				return true;
-			}
-			x += 2;
-		}
-		x = 1;
-	}
-	return true;
-}
-
-bool SymbolWatchdog::checkTent(int x, int y, int symbol) {
-	Point pos = { x, y };
-	int edges = (get(pos + Point({ 1, 0 })) == PATH) + (get(pos + Point({ 0, 1 })) == PATH) + (get(pos + Point({ -1, 0 })) == PATH) + (get(pos + Point({ 0, -1 })) == PATH);
-	if (edges == 0) return false;
-	x += 2;
-	for (; y < height; y += 2) {
-		while (x < width) {
-			pos = Point(x, y);
-			int symbol2 = get(pos);
-			if ((symbol2 & 0xF000000) == Decoration::Tent) {
-				int edges2 = (get(pos + Point({ 1, 0 })) == PATH) + (get(pos + Point({ 0, 1 })) == PATH) + (get(pos + Point({ -1, 0 })) == PATH) + (get(pos + Point({ 0, -1 })) == PATH);
-				return edges == edges2;
-			}
-			x += 2;
-		}
-		x = 1;
-	}
-	return true;
-}
-
-bool SymbolWatchdog::checkCircle(int x, int y, int symbol) {
-	std::set<Point> edges;
-	bool first = false;
-	for (int y2 = 1; y2 < height; y2 += 2) {
-		for (int x2 = 1; x2 < width; x2 += 2) {
-			Point pos = Point(x2, y2);
-			int symbol2 = get(pos);
-			if ((symbol2 & 0xF000000) == Decoration::Circle) {
-				if (!first && (x != x2 || y != y2))
-					return true;
-				first = true;
-				for (Point d : {Point(1, 0), Point(-1, 0), Point(0, 1), Point(0, -1) }) {
-					if (get(pos + d) == PATH) {
-						if (edges.count(d))
-							return false;
-						edges.insert(d);
-					}
-				}
-			}
-		}
-	}
-	return edges.size() == 4;
-}
-
-bool SymbolWatchdog::checkNewSymbolsF(int x, int y, int symbol) {
-	return true;
-}
-
-std::set<Point> SymbolWatchdog::get_region_for_watchdog(Point pos) {
-	std::set<Point> region;
-	std::vector<Point> check;
-	check.push_back(pos);
-	region.insert(pos);
-	while (check.size() > 0) {
-		Point p = check[check.size() - 1];
-		check.pop_back();
-		for (Point dir : { Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0) }) {
-			Point p1 = p + dir;
-			if (Point::pillarWidth == 0 && (p1.first == 0 || p1.first + 1 == width) || p1.second == 0 || p1.second + 1 == height) continue;
-			if (grid[p1.first][p1.second] == PATH) continue;
-			Point p2 = p + dir * 2;
-			if ((grid[p2.first][p2.second] & Decoration::Empty) == Decoration::Empty) continue;
-			if (region.insert(p2).second) {
-				check.push_back(p2);
-			}
-		}
-	}
-	return region;
-}
-
-std::set<int> SymbolWatchdog::get_symbols_in_region_for_watchdog(const std::set<Point>& region) {
-	std::set<int> symbols;
-	for (Point p : region) {
-		if (grid[p.first][p.second]) symbols.insert(grid[p.first][p.second]);
-	}
-	return symbols;
-}
-
-bool SymbolWatchdog::checkArrowPillar(int x, int y)
-{
-	int symbol = grid[x][y];
-	if ((symbol & 0x700) == Decoration::Triangle && (symbol & 0xf0000) != 0) {
-		int count = 0;
-		if (grid[x - 1][y] == PATH) count++;
-		if (grid[x + 1][y] == PATH) count++;
-		if (grid[x][y - 1] == PATH) count++;
-		if (grid[x][y + 1] == PATH) count++;
-		return count == (symbol >> 16);
-	}
-	if ((symbol & 0x700) != Decoration::Arrow)
-		return true;
-	int targetCount = (symbol & 0xf000) >> 12;
-	Point dir = DIRECTIONS[(symbol & 0xf0000) >> 16];
-	x = (x + (dir.first > 2 ? -2 : dir.first) / 2 + pillarWidth) % pillarWidth; y += dir.second / 2;
-	int count = 0;
-	while (y >= 0 && y < height) {
-		if (grid[x][y] == PATH) {
-			if (++count > targetCount) return false;
-		}
-		x = (x + dir.first + pillarWidth) % pillarWidth; y += dir.second;
-	}
-	return count == targetCount;
-}
-
 void BridgeWatchdog::action()
 {
 	int length1 = _memory->ReadPanelData<int>(id1, TRACED_EDGES);
@@ -3,6 +3,8 @@
 #include "Panel.h"
 #include "Randomizer.h"
 #include "Generate.h"
+#include "SymbolChecker.h"
+#include "PathChecker.h"
 
 class Watchdog
 {
@@ -12,8 +14,10 @@ public:
 		sleepTime = time;
 		_memory = std::make_shared<Memory>("witness64_d3d11.exe");
 	};
+	virtual ~Watchdog() { }
 	void start();
 	void run();
+	static thread_local std::vector<Watchdog*>* heldBack; //If set, watchdogs started on this thread go here instead, to be started later (see Speculation)
 	virtual void action() = 0;
 	float sleepTime;
 	bool terminate;
@@ -45,18 +49,16 @@ public:
 	virtual void action();
 };
 
-class SymbolWatchdog : public Watchdog {
+class SymbolWatchdog : public Watchdog, public SymbolChecker {
 public:
 	SymbolWatchdog(int id) : Watchdog(0.1f) {
 		Panel panel(id);
 		this->id = id;
-		grid = backupGrid = panel._grid;
-		width = static_cast<int>(grid.size());
-		height = static_cast<int>(grid[0].size());
-		pillarWidth = tracedLength = 0;
+		set_grid(panel._grid);
+		backupGrid = grid;
+		tracedLength = 0;
 		complete = false;
 		style = ReadPanelData<int>(id, STYLE_FLAGS);
-		DIRECTIONS = { Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0), Point(2, 2), Point(2, -2), Point(-2, -2), Point(-2, 2) };
 		if (ReadPanelData<int>(id, REFLECTION_DATA))
 			symmetryData = ReadArray<int>(id, REFLECTION_DATA, ReadPanelData<int>(id, NUM_DOTS));
 		for (Endpoint& e : panel._endpoints) {
@@ -70,44 +72,18 @@ public:
 	}
 	virtual void action();
 	void initPath();
-	bool check(int x, int y);
-	bool checkArrow(int x, int y, int symbol);
-	bool checkMine(int x, int y, int symbol);
-	bool checkHead(int x, int y, int symbol);
 	void DebugLog(int i);
-	bool checkMushroom(int x, int y, int symbol);
-	bool checkGhost(int x, int y, int symbol);
-	bool checkBar(int x, int y, int symbol);
-	std::set<Point> get_region_points_fw(Point pos);
-	std::vector<int> get_region_grid_patterns_fw(std::set<Point> points);
-	bool checkAntitriangle(int x, int y, int symbol);
-	int get(Point p);
-	bool check_it_is_corner(Point pos);
-	bool checkDart(int x, int y, int symbol);
-	bool checkRain(int x, int y, int symbol);
-	bool isSurrounded(Point pos, Point dir, int type);
-	bool checkPointer(int x, int y, int symbol);
-	bool checkDiamond(int x, int y, int symbol);
-	bool checkDice(int x, int y, int symbol);
-	bool checkBell(int x, int y, int symbol);
-	bool checkTent(int x, int y, int symbol);
-	bool checkCircle(int x, int y, int symbol);
-	bool checkNewSymbolsF(int x, int y, int symbol);
-	std::set<Point> get_region_for_watchdog(Point pos);
-	std::set<int> get_symbols_in_region_for_watchdog(const std::set<Point>& region);
-	bool checkArrowPillar(int x, int y);
 
 	int id;
 	std::vector<std::vector<int>> backupGrid;
-	std::vector<std::vector<int>> grid;
-	int width, height, pillarWidth;
 	int tracedLength;
 	bool complete;
 	int style;
 	std::vector<int> exits;
 	int exitPoint;
 	std::vector<int> symmetryData;
-	std::vector<Point> DIRECTIONS;
+	std::vector<Point> pathPoints; //Points of the traced path, in the order they were traced
+	std::shared_ptr<PathChecker> pathChecker; //Follows the traced path to catch broken symbols as soon as they happen
 	template<class T>
 	T pick_random_fw(const std::set<T>& set);
 };